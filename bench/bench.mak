@@ -0,0 +1,24 @@
+
+CC:= gcc
+
+INCLUDE+=../src
+CFLAGS+=-I$(INCLUDE)
+LDFLAGS+=
+LIBS+=
+
+SRCS:=$(wildcard *.c)
+OBJS:=$(patsubst %.c,%.o, $(SRCS))
+TARGET:=$(patsubst %.c,%.out, $(SRCS))
+
+all:$(TARGET)
+
+%.out:%.o $(wildcard ../src/*.o)
+	$(CC) $(CFLAGS) -o $@ $< $(wildcard ../src/*.o) $(LDFLAGS) $(LIBS)
+
+%.o:%.c
+	$(CC) $(CFLAGS) -o $@ -c $< $(LDFLAGS) $(LIBS)
+
+clean:
+	rm -f *.o *.out
+
+.PHONY:all clean
@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "mpmcqueue.h"
+#include "blkqueue.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cputime(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static struct m_mpmcqueue ping;
+static struct m_mpmcqueue pong;
+static struct m_blkqueue bping;
+static struct m_blkqueue bpong;
+static size_t rounds;
+
+/* poll with sleep, the way callers do without a blocking queue */
+static void *poll_echo(void *arg)
+{
+    size_t i = 0;
+    void *elem = NULL;
+    struct timespec ts = {0, 50000};
+
+    for (i = 0; i < rounds; i++) {
+        while ((elem = m_mpmcqueue_try_deque(&ping)) == NULL)
+            nanosleep(&ts, NULL);
+        m_mpmcqueue_try_enque(&pong, elem);
+    }
+
+    return NULL;
+}
+
+static void *block_echo(void *arg)
+{
+    size_t i = 0;
+
+    for (i = 0; i < rounds; i++)
+        m_blkqueue_enque_wait(&bpong, m_blkqueue_deque_wait(&bping, -1), -1);
+
+    return NULL;
+}
+
+static void bench_poll(void)
+{
+    size_t i = 0;
+    double t = 0;
+    double c = 0;
+    pthread_t tid;
+    struct timespec ts = {0, 50000};
+
+    m_mpmcqueue_init(&ping, 16);
+    m_mpmcqueue_init(&pong, 16);
+    pthread_create(&tid, NULL, poll_echo, NULL);
+    t = now();
+    c = cputime();
+    for (i = 0; i < rounds; i++) {
+        m_mpmcqueue_try_enque(&ping, (void *)1);
+        while (m_mpmcqueue_try_deque(&pong) == NULL)
+            nanosleep(&ts, NULL);
+    }
+    t = now() - t;
+    c = cputime() - c;
+    pthread_join(tid, NULL);
+    printf("%-6s n=%-8lu %8.3f s %8.2f us/rt cpu %6.2f us/rt\n", "poll",
+                    (unsigned long)rounds, t, t * 1e6 / rounds, c * 1e6 / rounds);
+    m_mpmcqueue_free(&ping, NULL, NULL);
+    m_mpmcqueue_free(&pong, NULL, NULL);
+}
+
+static void bench_block(void)
+{
+    size_t i = 0;
+    double t = 0;
+    double c = 0;
+    pthread_t tid;
+
+    m_blkqueue_init(&bping, 16);
+    m_blkqueue_init(&bpong, 16);
+    pthread_create(&tid, NULL, block_echo, NULL);
+    t = now();
+    c = cputime();
+    for (i = 0; i < rounds; i++) {
+        m_blkqueue_enque_wait(&bping, (void *)1, -1);
+        m_blkqueue_deque_wait(&bpong, -1);
+    }
+    t = now() - t;
+    c = cputime() - c;
+    pthread_join(tid, NULL);
+    printf("%-6s n=%-8lu %8.3f s %8.2f us/rt cpu %6.2f us/rt\n", "block",
+                    (unsigned long)rounds, t, t * 1e6 / rounds, c * 1e6 / rounds);
+    m_blkqueue_free(&bping, NULL, NULL);
+    m_blkqueue_free(&bpong, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    rounds = argc > 1 ? (size_t)atol(argv[1]) : 20000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    bench_poll();
+    bench_block();
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "circlequeue.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* move 'count' pointers through the queue in batches of 'batch' */
+static void bench(size_t count, size_t batch, int bulk)
+{
+    size_t i = 0;
+    size_t j = 0;
+    double t = 0;
+    void *elems[256];
+    void *out[256];
+    struct m_cirqueue que;
+
+    for (i = 0; i < batch; i++)
+        elems[i] = &elems[i];
+    m_cirqueue_init(&que, 1000);
+
+    t = now();
+    for (i = 0; i < count; i += batch) {
+        if (bulk) {
+            m_cirqueue_enque_bulk(&que, elems, batch, NULL, NULL);
+            m_cirqueue_deque_bulk(&que, out, batch);
+        } else {
+            for (j = 0; j < batch; j++)
+                m_cirqueue_enque(&que, elems[j], NULL, NULL);
+            for (j = 0; j < batch; j++)
+                out[j] = m_cirqueue_deque(&que);
+        }
+    }
+    t = now() - t;
+    printf("%-6s batch=%-4lu %8.3f s %8.2f ns/elem\n", bulk ? "bulk" : "single",
+                    (unsigned long)batch, t, t * 1e9 / count);
+    m_cirqueue_free(&que, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t batch = 0;
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 100000000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    for (batch = 8; batch <= 256; batch *= 2) {
+        bench(count, batch, 0);
+        bench(count, batch, 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "heap.h"
+
+struct element {
+    int key;
+};
+
+static int cbk_compare(void *elem1, void *elem2, void *udt)
+{
+    struct element *em1 = (struct element *)elem1;
+    struct element *em2 = (struct element *)elem2;
+    if (em1->key > em2->key)
+        return 1;
+    else if (em1->key < em2->key)
+        return -1;
+    else
+        return 0;
+}
+
+static union m_heapkey cbk_getkey(void *elem, void *udt)
+{
+    union m_heapkey key;
+    key.i = ((struct element *)elem)->key;
+    return key;
+}
+
+#define elem_cmp(a,b) (((a)->key > (b)->key) - ((a)->key < (b)->key))
+M_HEAP_DEFINE(eheap, struct element, elem_cmp, M_HEAP_MIN)
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, size_t n, double t)
+{
+    printf("%-10s n=%-10lu %8.3f s %8.2f ns/op\n", name, (unsigned long)n,
+                    t, t * 1e9 / (2.0 * n));
+}
+
+static void bench_callback(struct element *elems, size_t n,
+                    const char *name, int type, int flag, int keyed)
+{
+    size_t i = 0;
+    double t = 0;
+    struct m_heap heap;
+
+    m_heap_init(&heap, type, M_HEAP_INC | flag, 1024, cbk_compare, NULL);
+    if (keyed)
+        m_heap_set_key(&heap, M_HEAP_KEY_INT, cbk_getkey);
+    t = now();
+    for (i = 0; i < n; i++)
+        m_heap_insert(&heap, &elems[i]);
+    for (i = 0; i < n; i++)
+        m_heap_pop(&heap);
+    report(name, n, now() - t);
+    m_heap_free(&heap, NULL, NULL);
+}
+
+static void bench_build(struct element *elems, size_t n)
+{
+    size_t i = 0;
+    double t = 0;
+    void **ptrs = NULL;
+    struct m_heap heap;
+
+    ptrs = (void **)malloc(sizeof(void *) * n);
+    for (i = 0; i < n; i++)
+        ptrs[i] = &elems[i];
+
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC, 1024, cbk_compare, NULL);
+    t = now();
+    for (i = 0; i < n; i++)
+        m_heap_insert(&heap, ptrs[i]);
+    t = now() - t;
+    printf("%-10s n=%-10lu %8.3f s %8.2f ns/elem\n", "insert", (unsigned long)n,
+                    t, t * 1e9 / n);
+    m_heap_free(&heap, NULL, NULL);
+
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC, 1024, cbk_compare, NULL);
+    t = now();
+    m_heap_build(&heap, ptrs, n);
+    t = now() - t;
+    printf("%-10s n=%-10lu %8.3f s %8.2f ns/elem\n", "build", (unsigned long)n,
+                    t, t * 1e9 / n);
+    m_heap_free(&heap, NULL, NULL);
+    free(ptrs);
+}
+
+static void bench_define(struct element *elems, size_t n)
+{
+    size_t i = 0;
+    double t = 0;
+    struct m_heap heap;
+
+    eheap_init(&heap, M_HEAP_INC, 1024);
+    t = now();
+    for (i = 0; i < n; i++)
+        eheap_insert(&heap, &elems[i]);
+    for (i = 0; i < n; i++)
+        eheap_pop(&heap);
+    report("define", n, now() - t);
+    m_heap_free(&heap, NULL, NULL);
+}
+
+/* largest 'k' of the stream, whole stream in heap vs bounded heap */
+static void bench_topk(struct element *elems, size_t n, size_t k)
+{
+    size_t i = 0;
+    double t = 0;
+    void **out = NULL;
+    struct m_heap heap;
+
+    out = (void **)malloc(sizeof(void *) * k);
+    m_heap_init(&heap, M_HEAP_MAX, M_HEAP_INC, 1024, cbk_compare, NULL);
+    t = now();
+    for (i = 0; i < n; i++)
+        m_heap_insert(&heap, &elems[i]);
+    m_heap_pop_n(&heap, out, k);
+    t = now() - t;
+    printf("%-10s n=%-10lu %8.3f s %8.2f ns/elem\n", "topk full",
+                    (unsigned long)n, t, t * 1e9 / n);
+    m_heap_free(&heap, NULL, NULL);
+
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_NOINC, k, cbk_compare, NULL);
+    t = now();
+    for (i = 0; i < n; i++)
+        m_heap_offer(&heap, &elems[i]);
+    m_heap_pop_n(&heap, out, k);
+    t = now() - t;
+    printf("%-10s n=%-10lu %8.3f s %8.2f ns/elem\n", "topk offer",
+                    (unsigned long)n, t, t * 1e9 / n);
+    m_heap_free(&heap, NULL, NULL);
+    free(out);
+}
+
+int main(int argc, char *argv[])
+{
+    int a = 0;
+    size_t i = 0;
+    size_t n = 0;
+    struct element *elems = NULL;
+    static const char *defargv[] = {"", "1000", "1000000"};
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    if (argc < 2) {
+        argc = 3;
+        argv = (char **)defargv;
+    }
+
+    for (a = 1; a < argc; a++) {
+        n = (size_t)atol(argv[a]);
+        elems = (struct element *)malloc(sizeof(struct element) * n);
+        if (!elems) {
+            printf("malloc %lu elements failed\n", (unsigned long)n);
+            return -1;
+        }
+        srand(9);
+        for (i = 0; i < n; i++)
+            elems[i].key = rand();
+
+        bench_callback(elems, n, "callback", M_HEAP_MIN, M_HEAP_ARITY2, 0);
+        bench_callback(elems, n, "4-ary", M_HEAP_MIN, M_HEAP_ARITY4, 0);
+        bench_callback(elems, n, "8-ary", M_HEAP_MIN, M_HEAP_ARITY8, 0);
+        bench_callback(elems, n, "key", M_HEAP_MIN, M_HEAP_ARITY2, 1);
+        bench_callback(elems, n, "key 4-ary", M_HEAP_MIN, M_HEAP_ARITY4, 1);
+        bench_callback(elems, n, "minmax", M_HEAP_MINMAX, 0, 0);
+        bench_callback(elems, n, "minmax key", M_HEAP_MINMAX, 0, 1);
+        bench_define(elems, n);
+        bench_build(elems, n);
+        bench_topk(elems, n, 1000);
+        free(elems);
+    }
+
+    return 0;
+}
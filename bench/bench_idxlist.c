@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "list.h"
+#include "idxlist.h"
+
+struct element {
+    int key;
+    struct m_listnode listnode;
+    struct m_idxnode idxnode;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 'ops' random nth, index and positional insert on a list of 'count' */
+static void bench(struct element *elems, size_t count, size_t ops)
+{
+    size_t i = 0;
+    long sum = 0;
+    double t[6];
+    struct m_list list;
+    struct m_idxlist idx;
+
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+    m_idxlist_init(&idx, M_LIST_OFFSET(struct element, idxnode));
+    for (i = 0; i < count; i++) {
+        elems[i].key = (int)i;
+        m_list_append(&list, &elems[i]);
+        m_idxlist_append(&idx, &elems[i]);
+    }
+
+    srand(1);
+    t[0] = now();
+    for (i = 0; i < ops; i++)
+        sum += ((struct element *)m_list_nth(&list, rand() % count + 1))->key;
+    t[0] = now() - t[0];
+    srand(1);
+    t[1] = now();
+    for (i = 0; i < ops; i++)
+        sum += ((struct element *)m_idxlist_nth(&idx, rand() % count + 1))->key;
+    t[1] = now() - t[1];
+
+    t[2] = now();
+    for (i = 0; i < ops; i++)
+        sum += m_list_index(&list, &elems[rand() % count]);
+    t[2] = now() - t[2];
+    t[3] = now();
+    for (i = 0; i < ops; i++)
+        sum += m_idxlist_index(&idx, &elems[rand() % count]);
+    t[3] = now() - t[3];
+
+    /* move a random element to a random position */
+    t[4] = now();
+    for (i = 0; i < ops; i++)
+        m_list_insert(&list, m_list_pop(&list, rand() % count + 1),
+                    rand() % count + 1);
+    t[4] = now() - t[4];
+    t[5] = now();
+    for (i = 0; i < ops; i++)
+        m_idxlist_insert(&idx, m_idxlist_pop(&idx, rand() % count + 1),
+                    rand() % count + 1);
+    t[5] = now() - t[5];
+
+    printf("count=%-8lu %-8s %10.1f ns/op %-8s %10.1f ns/op\n",
+                    (unsigned long)count, "nth", t[0] * 1e9 / ops,
+                    "idx nth", t[1] * 1e9 / ops);
+    printf("count=%-8lu %-8s %10.1f ns/op %-8s %10.1f ns/op\n",
+                    (unsigned long)count, "index", t[2] * 1e9 / ops,
+                    "idx", t[3] * 1e9 / ops);
+    printf("count=%-8lu %-8s %10.1f ns/op %-8s %10.1f ns/op  (%ld)\n",
+                    (unsigned long)count, "move", t[4] * 1e9 / ops,
+                    "idx move", t[5] * 1e9 / ops, sum & 1);
+
+    m_idxlist_free(&idx, NULL, NULL);
+    m_list_free(&list, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = 0;
+    size_t max = argc > 1 ? (size_t)atol(argv[1]) : 500000;
+    struct element *elems = NULL;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    elems = (struct element *)malloc(sizeof(struct element) * max);
+    if (!elems)
+        return 1;
+    for (count = 1000; count <= max; count *= 10)
+        bench(elems, count, count < 100000 ? 20000 : 2000);
+    if (count / 10 != max)
+        bench(elems, max, 2000);
+    free(elems);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "list.h"
+#include "listhash.h"
+
+struct element {
+    long key;
+    struct m_listnode listnode;
+    struct m_listnode hlistnode;
+    struct m_hashnode hashnode;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t cbk_hash(void *key, void *udt)
+{
+    return (size_t)key * 2654435761UL;
+}
+
+static int cbk_cmp(void *elem, void *key, void *udt)
+{
+    return ((struct element *)elem)->key == (long)key ? 0 : -1;
+}
+
+/* 'ops' random lookups of 'count' keys by scan and by hash index */
+static void bench(struct element *elems, size_t count, size_t ops)
+{
+    size_t i = 0;
+    long sum = 0;
+    double t[2];
+    struct m_list list;
+    struct m_listhash lh;
+
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+    m_listhash_init(&lh, M_LIST_OFFSET(struct element, hlistnode),
+                    M_LIST_OFFSET(struct element, hashnode), 16,
+                    cbk_hash, cbk_cmp, NULL);
+    for (i = 0; i < count; i++) {
+        elems[i].key = (long)i + 1; /* m_list_find takes no NULL key */
+        m_list_append(&list, &elems[i]);
+        m_listhash_insert(&lh, &elems[i], (void *)elems[i].key);
+    }
+
+    srand(1);
+    t[0] = now();
+    for (i = 0; i < ops; i++)
+        sum += ((struct element *)m_list_find(&list,
+                    (void *)(long)(rand() % count + 1), cbk_cmp, NULL))->key;
+    t[0] = now() - t[0];
+    srand(1);
+    t[1] = now();
+    for (i = 0; i < ops; i++)
+        sum += ((struct element *)m_listhash_find(&lh,
+                    (void *)(long)(rand() % count + 1)))->key;
+    t[1] = now() - t[1];
+
+    printf("count=%-8lu m_list_find %12.1f ns/op  m_listhash_find %6.1f ns/op"
+                    "  (%ld)\n", (unsigned long)count, t[0] * 1e9 / ops,
+                    t[1] * 1e9 / ops, sum & 1);
+
+    m_listhash_free(&lh, NULL, NULL);
+    m_list_free(&list, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = 0;
+    size_t max = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    struct element *elems = NULL;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    elems = (struct element *)malloc(sizeof(struct element) * max);
+    if (!elems)
+        return 1;
+    for (count = 100; count <= max; count *= 10)
+        bench(elems, count, count < 100000 ? 100000 : 1000);
+    free(elems);
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "magicring.h"
+
+#define CAP     (1 << 16)
+
+struct header {
+    int seq;
+    int len;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* copy 'n' bytes into plain ring at 'off', split at the end */
+static void plain_put(char *ring, size_t off, const char *src, size_t n)
+{
+    size_t first = CAP - (off & (CAP - 1));
+    if (first > n)
+        first = n;
+    memcpy(ring + (off & (CAP - 1)), src, first);
+    memcpy(ring, src + first, n - first);
+}
+
+/* copy 'n' bytes out of plain ring at 'off', split at the end */
+static void plain_get(const char *ring, size_t off, char *dst, size_t n)
+{
+    size_t first = CAP - (off & (CAP - 1));
+    if (first > n)
+        first = n;
+    memcpy(dst, ring + (off & (CAP - 1)), first);
+    memcpy(dst + first, ring, n - first);
+}
+
+static long parse(const char *p, int len)
+{
+    int i = 0;
+    long sum = 0;
+    for (i = 0; i < len; i++)
+        sum += p[i];
+    return sum;
+}
+
+/* records staged and reassembled through scratch buffers */
+static void bench_plain(size_t count)
+{
+    size_t i = 0;
+    size_t head = 0;
+    size_t tail = 0;
+    long sum = 0;
+    double t = 0;
+    char *ring = (char *)malloc(CAP);
+    char buf[512];
+    struct header hdr;
+
+    memset(buf, 1, sizeof(buf));
+    t = now();
+    for (i = 0; i < count; i++) {
+        hdr.seq = (int)i;
+        hdr.len = (int)(i * 7 % 301);
+        memcpy(buf, &hdr, sizeof(hdr));
+        plain_put(ring, tail, buf, sizeof(hdr) + hdr.len);
+        tail += sizeof(hdr) + hdr.len;
+
+        plain_get(ring, head, buf, sizeof(hdr));
+        memcpy(&hdr, buf, sizeof(hdr));
+        plain_get(ring, head, buf, sizeof(hdr) + hdr.len);
+        sum += parse(buf + sizeof(hdr), hdr.len);
+        head += sizeof(hdr) + hdr.len;
+    }
+    t = now() - t;
+    printf("%-6s n=%-10lu %8.3f s %8.2f ns/rec (%ld)\n", "plain",
+                    (unsigned long)count, t, t * 1e9 / count, sum % 10);
+    free(ring);
+}
+
+/* records written and parsed in ring memory */
+static void bench_magic(size_t count)
+{
+    size_t i = 0;
+    size_t num = 0;
+    long sum = 0;
+    double t = 0;
+    char *p = NULL;
+    struct header hdr;
+    struct m_magicring ring;
+
+    m_magicring_init(&ring, CAP);
+    t = now();
+    for (i = 0; i < count; i++) {
+        hdr.seq = (int)i;
+        hdr.len = (int)(i * 7 % 301);
+        p = (char *)m_magicring_reserve(&ring, sizeof(hdr) + hdr.len, &num);
+        memcpy(p, &hdr, sizeof(hdr));
+        memset(p + sizeof(hdr), 1, hdr.len);
+        m_magicring_commit(&ring, sizeof(hdr) + hdr.len);
+
+        p = (char *)m_magicring_peek(&ring, sizeof(hdr), &num);
+        memcpy(&hdr, p, sizeof(hdr));
+        sum += parse(p + sizeof(hdr), hdr.len);
+        m_magicring_release(&ring, sizeof(hdr) + hdr.len);
+    }
+    t = now() - t;
+    printf("%-6s n=%-10lu %8.3f s %8.2f ns/rec (%ld)\n", "magic",
+                    (unsigned long)count, t, t * 1e9 / count, sum % 10);
+    m_magicring_free(&ring);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    bench_plain(count);
+    bench_magic(count);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "circlequeue.h"
+#include "mpmcqueue.h"
+
+#define CAPACITY    1024
+#define PREFILL     512
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* queue under test, mutex guarded m_cirqueue or m_mpmcqueue */
+static struct m_cirqueue cq;
+static pthread_mutex_t cq_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct m_mpmcqueue mq;
+static int use_mpmc = 0;
+static size_t ops = 0;
+
+static void q_enque(void *elem)
+{
+    if (use_mpmc) {
+        m_mpmcqueue_enque(&mq, elem);
+        return;
+    }
+    pthread_mutex_lock(&cq_lock);
+    m_cirqueue_enque(&cq, elem, NULL, NULL);
+    pthread_mutex_unlock(&cq_lock);
+}
+
+static void *q_deque(void)
+{
+    void *elem = NULL;
+    if (use_mpmc)
+        return m_mpmcqueue_deque(&mq);
+    for (;;) {
+        pthread_mutex_lock(&cq_lock);
+        elem = m_cirqueue_deque(&cq);
+        pthread_mutex_unlock(&cq_lock);
+        if (elem)
+            return elem;
+        sched_yield();
+    }
+}
+
+/* take one element, hand it back, like a worker pool passing jobs */
+static void *worker(void *arg)
+{
+    size_t i = 0;
+
+    for (i = 0; i < ops; i++)
+        q_enque(q_deque());
+
+    return NULL;
+}
+
+static void run(const char *name, int threads)
+{
+    int i = 0;
+    double t = 0;
+    pthread_t *tids = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+
+    for (i = 1; i <= PREFILL; i++)
+        q_enque((void *)(size_t)i);
+
+    t = now();
+    for (i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, worker, NULL);
+    for (i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    t = now() - t;
+
+    printf("%-6s threads=%-3d %8.3f s %8.2f Mops/s\n", name, threads, t,
+                    2.0 * ops * threads / t / 1e6);
+    free(tids);
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = 0;
+    int maxthreads = argc > 1 ? atoi(argv[1]) : 64;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    ops = argc > 2 ? (size_t)atol(argv[2]) : 100000;
+
+    for (threads = 1; threads <= maxthreads; threads *= 2) {
+        use_mpmc = 0;
+        m_cirqueue_init(&cq, CAPACITY);
+        run("mutex", threads);
+        m_cirqueue_free(&cq, NULL, NULL);
+
+        use_mpmc = 1;
+        m_mpmcqueue_init(&mq, CAPACITY);
+        run("mpmc", threads);
+        m_mpmcqueue_free(&mq, NULL, NULL);
+    }
+
+    return 0;
+}
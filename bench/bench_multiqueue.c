@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "heap.h"
+#include "multiqueue.h"
+
+#define PREFILL 100000
+
+struct element {
+    int key;
+};
+
+static int cbk_compare(void *elem1, void *elem2, void *udt)
+{
+    struct element *em1 = (struct element *)elem1;
+    struct element *em2 = (struct element *)elem2;
+    if (em1->key > em2->key)
+        return 1;
+    else if (em1->key < em2->key)
+        return -1;
+    else
+        return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* queue under test, 'mutex' heap or multiqueue */
+static struct m_heap heap;
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct m_multiqueue mq;
+static int use_mq = 0;
+static size_t ops = 0;
+
+static void q_insert(void *elem)
+{
+    if (use_mq) {
+        m_multiqueue_insert(&mq, elem);
+    } else {
+        pthread_mutex_lock(&heap_lock);
+        m_heap_insert(&heap, elem);
+        pthread_mutex_unlock(&heap_lock);
+    }
+}
+
+static void *q_pop(void)
+{
+    void *elem = NULL;
+    if (use_mq)
+        return m_multiqueue_pop(&mq);
+    pthread_mutex_lock(&heap_lock);
+    elem = m_heap_pop(&heap);
+    pthread_mutex_unlock(&heap_lock);
+    return elem;
+}
+
+/* pop one element, re-insert it with a later key */
+static void *worker(void *arg)
+{
+    size_t i = 0;
+    unsigned int seed = (unsigned int)(size_t)arg;
+    struct element *em = NULL;
+
+    for (i = 0; i < ops; i++) {
+        em = (struct element *)q_pop();
+        if (!em)
+            continue;
+        seed = seed * 1103515245 + 12345;
+        em->key += (seed >> 16) % 1000;
+        q_insert(em);
+    }
+
+    return NULL;
+}
+
+static void run(const char *name, int threads, struct element *elems)
+{
+    int i = 0;
+    double t = 0;
+    pthread_t *tids = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+
+    for (i = 0; i < PREFILL; i++) {
+        elems[i].key = rand() % 1000;
+        q_insert(&elems[i]);
+    }
+
+    t = now();
+    for (i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, worker, (void *)(size_t)(i + 1));
+    for (i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    t = now() - t;
+
+    printf("%-8s threads=%-3d %8.3f s %8.2f Mops/s\n", name, threads, t,
+                    2.0 * ops * threads / t / 1e6);
+    free(tids);
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = 0;
+    int maxthreads = argc > 1 ? atoi(argv[1]) : 8;
+    struct element *elems = NULL;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    ops = argc > 2 ? (size_t)atol(argv[2]) : 200000;
+    elems = (struct element *)malloc(sizeof(struct element) * PREFILL);
+
+    for (threads = 1; threads <= maxthreads; threads *= 2) {
+        use_mq = 0;
+        m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC, 1024, cbk_compare, NULL);
+        run("mutex", threads, elems);
+        m_heap_free(&heap, NULL, NULL);
+
+        use_mq = 1;
+        m_multiqueue_init(&mq, M_HEAP_MIN, M_MQ_RELAXED, 2 * threads + 2,
+                        cbk_compare, NULL);
+        run("relaxed", threads, elems);
+        m_multiqueue_free(&mq, NULL, NULL);
+
+        m_multiqueue_init(&mq, M_HEAP_MIN, M_MQ_STRICT, 2 * threads + 2,
+                        cbk_compare, NULL);
+        run("strict", threads, elems);
+        m_multiqueue_free(&mq, NULL, NULL);
+    }
+    free(elems);
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rbtree.h"
+#include "avltree.h"
+
+#define FLUSH   (64 << 20) /* bytes written to push everything out of cache */
+
+/* key and nodes sit on different cache lines, like a real record */
+struct element {
+    long key;
+    char payload[56];
+    struct m_rbnode rbnode;
+    struct m_avlnode avlnode;
+};
+
+static char *flushbuf = NULL;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void flush(void)
+{
+    memset(flushbuf, (int)(now() * 1000), FLUSH);
+}
+
+static void sum_cbk(void *elem, void *udt)
+{
+    *(long *)udt += ((struct element *)elem)->key;
+}
+
+static int cmp_rb(void *ielem, void *elem, void *udt)
+{
+    long a = ((struct element *)ielem)->key;
+    long b = ((struct element *)elem)->key;
+    return a < b ? -1 : a > b;
+}
+
+static void bench_tree(struct m_rbtree *rb, struct m_avltree *avl,
+                    size_t count)
+{
+    long sum = 0;
+    double t[4];
+
+    flush();
+    t[0] = now();
+    m_rbtree_inorder(rb, sum_cbk, &sum);
+    t[0] = now() - t[0];
+    flush();
+    t[1] = now();
+    m_rbtree_inorder_prefetch(rb, sum_cbk, &sum);
+    t[1] = now() - t[1];
+    flush();
+    t[2] = now();
+    m_avltree_inorder(avl, sum_cbk, &sum);
+    t[2] = now() - t[2];
+    flush();
+    t[3] = now();
+    m_avltree_inorder_prefetch(avl, sum_cbk, &sum);
+    t[3] = now() - t[3];
+
+    printf("rbtree inorder  %8.2f ns/elem  inorder_prefetch %8.2f ns/elem\n",
+                    t[0] * 1e9 / count, t[1] * 1e9 / count);
+    printf("avltree inorder %8.2f ns/elem  inorder_prefetch %8.2f ns/elem"
+                    "  (%ld)\n", t[2] * 1e9 / count, t[3] * 1e9 / count,
+                    sum & 1);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    struct element **elems = NULL;
+    struct element *temp = NULL;
+    struct m_rbtree rb;
+    struct m_avltree avl;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    flushbuf = (char *)malloc(FLUSH);
+    elems = (struct element **)malloc(sizeof(struct element *) * count);
+    if (!flushbuf || !elems)
+        return 1;
+
+    /* allocate in one order, link in a shuffled one */
+    for (i = 0; i < count; i++)
+        elems[i] = (struct element *)malloc(sizeof(struct element));
+    srand(1);
+    for (i = count - 1; i > 0; i--) {
+        j = ((size_t)rand() * RAND_MAX + rand()) % (i + 1);
+        temp = elems[i];
+        elems[i] = elems[j];
+        elems[j] = temp;
+    }
+    m_rbtree_init(&rb, M_RBTREE_OFFSET(struct element, rbnode));
+    m_avltree_init(&avl, M_AVLTREE_OFFSET(struct element, avlnode));
+    for (i = 0; i < count; i++) {
+        /* keys follow shuffled order, inorder walks a scattered path */
+        elems[i]->key = (long)i;
+        m_rbtree_insert(&rb, elems[i], cmp_rb, NULL);
+        m_avltree_insert(&avl, elems[i], cmp_rb, NULL);
+    }
+
+    printf("count=%lu shuffled allocation, cold cache\n",
+                    (unsigned long)count);
+    bench_tree(&rb, &avl, count);
+
+    for (i = 0; i < count; i++)
+        free(elems[i]);
+    free(elems);
+    free(flushbuf);
+
+    return 0;
+}
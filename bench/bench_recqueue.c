@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "circlequeue.h"
+#include "recqueue.h"
+
+struct message {
+    long seq;
+    char payload[56];
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* one malloc per message, pointer through m_cirqueue */
+static void bench_pointer(size_t count, size_t batch)
+{
+    size_t i = 0;
+    size_t j = 0;
+    long sum = 0;
+    double t = 0;
+    struct message *msg = NULL;
+    struct m_cirqueue que;
+
+    m_cirqueue_init(&que, 1024);
+    t = now();
+    for (i = 0; i < count; i += batch) {
+        for (j = 0; j < batch; j++) {
+            msg = (struct message *)malloc(sizeof(struct message));
+            msg->seq = i + j;
+            memset(msg->payload, 1, sizeof(msg->payload));
+            m_cirqueue_enque(&que, msg, NULL, NULL);
+        }
+        for (j = 0; j < batch; j++) {
+            msg = (struct message *)m_cirqueue_deque(&que);
+            sum += msg->seq + msg->payload[j % 56];
+            free(msg);
+        }
+    }
+    t = now() - t;
+    printf("%-8s batch=%-3lu %8.3f s %8.2f ns/msg (%ld)\n", "pointer",
+                    (unsigned long)batch, t, t * 1e9 / count, sum % 10);
+    m_cirqueue_free(&que, NULL, NULL);
+}
+
+/* messages written and read in place */
+static void bench_inline(size_t count, size_t batch)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t num = 0;
+    long sum = 0;
+    double t = 0;
+    struct message *msg = NULL;
+    struct m_recqueue que;
+
+    m_recqueue_init(&que, sizeof(struct message), 1024);
+    t = now();
+    for (i = 0; i < count; i += num) {
+        msg = (struct message *)m_recqueue_reserve(&que, batch, &num);
+        for (j = 0; j < num; j++) {
+            msg[j].seq = i + j;
+            memset(msg[j].payload, 1, sizeof(msg[j].payload));
+        }
+        m_recqueue_commit(&que, num);
+        msg = (struct message *)m_recqueue_peek(&que, num, &num);
+        for (j = 0; j < num; j++)
+            sum += msg[j].seq + msg[j].payload[j % 56];
+        m_recqueue_release(&que, num);
+    }
+    t = now() - t;
+    printf("%-8s batch=%-3lu %8.3f s %8.2f ns/msg (%ld)\n", "inline",
+                    (unsigned long)batch, t, t * 1e9 / count, sum % 10);
+    m_recqueue_free(&que, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 20000000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    bench_pointer(count, 1);
+    bench_inline(count, 1);
+    bench_pointer(count, 32);
+    bench_inline(count, 32);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "circlequeue.h"
+#include "segqueue.h"
+
+#define PEAK    (1 << 20)
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* mostly shallow queue with a rare burst to PEAK */
+static size_t depth(size_t round)
+{
+    return round % 100 == 99 ? PEAK : 64;
+}
+
+static void bench_cirqueue(size_t rounds)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t ops = 0;
+    long sum = 0;
+    double t = 0;
+    struct m_cirqueue que;
+
+    /* must be sized for the burst */
+    m_cirqueue_init(&que, PEAK);
+    t = now();
+    for (i = 0; i < rounds; i++) {
+        for (j = 0; j < depth(i); j++)
+            m_cirqueue_enque(&que, (void *)(j + 1), NULL, NULL);
+        for (j = 0; j < depth(i); j++)
+            sum += (long)m_cirqueue_deque(&que);
+        ops += depth(i);
+    }
+    t = now() - t;
+    printf("%-9s %8.3f s %8.2f ns/op mem %8lu KB (%ld)\n", "cirqueue",
+                    t, t * 1e9 / ops,
+                    (unsigned long)(PEAK * sizeof(void *) / 1024), sum % 10);
+    m_cirqueue_free(&que, NULL, NULL);
+}
+
+static void bench_segqueue(size_t rounds, size_t segnum)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t ops = 0;
+    long sum = 0;
+    double t = 0;
+    char name[32];
+    struct m_segqueue que;
+
+    m_segqueue_init(&que, segnum, 8);
+    t = now();
+    for (i = 0; i < rounds; i++) {
+        for (j = 0; j < depth(i); j++)
+            m_segqueue_enque(&que, (void *)(j + 1));
+        for (j = 0; j < depth(i); j++)
+            sum += (long)m_segqueue_deque(&que);
+        ops += depth(i);
+    }
+    t = now() - t;
+    sprintf(name, "seg/%lu", (unsigned long)segnum);
+    printf("%-9s %8.3f s %8.2f ns/op mem %8lu KB (%ld)\n", name,
+                    t, t * 1e9 / ops, (unsigned long)((que.nseg + que.ncache) *
+                    (sizeof(struct m_segment) + segnum * sizeof(void *)) / 1024),
+                    sum % 10);
+    m_segqueue_free(&que, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rounds = argc > 1 ? (size_t)atol(argv[1]) : 1000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    bench_cirqueue(rounds);
+    bench_segqueue(rounds, 64);
+    bench_segqueue(rounds, 1024);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "circlequeue.h"
+#include "spscqueue.h"
+
+#define BATCH 64
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* queue under test, mutex guarded m_cirqueue or m_spscqueue */
+static struct m_cirqueue cq;
+static pthread_mutex_t cq_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct m_spscqueue sq;
+static int use_spsc = 0;
+static size_t count = 0;
+
+static int q_enque(void *elem)
+{
+    int ret = M_ETOOMANY;
+    if (use_spsc)
+        return m_spscqueue_enque(&sq, elem);
+    pthread_mutex_lock(&cq_lock);
+    if (cq.num < cq.maxnum)
+        ret = m_cirqueue_enque(&cq, elem, NULL, NULL);
+    pthread_mutex_unlock(&cq_lock);
+    return ret;
+}
+
+static void *q_deque(void)
+{
+    void *elem = NULL;
+    if (use_spsc)
+        return m_spscqueue_deque(&sq);
+    pthread_mutex_lock(&cq_lock);
+    elem = m_cirqueue_deque(&cq);
+    pthread_mutex_unlock(&cq_lock);
+    return elem;
+}
+
+static void *producer(void *arg)
+{
+    size_t i = 0;
+
+    for (i = 1; i <= count; i++)
+        while (q_enque((void *)i))
+            sched_yield();
+
+    return NULL;
+}
+
+static void run(const char *name)
+{
+    size_t i = 0;
+    double t = 0;
+    pthread_t tid;
+
+    /* one thread, enqueue a batch then dequeue it */
+    t = now();
+    for (i = 0; i < count; i += BATCH) {
+        size_t j = 0;
+        for (j = 1; j <= BATCH; j++)
+            q_enque((void *)j);
+        for (j = 0; j < BATCH; j++)
+            q_deque();
+    }
+    t = now() - t;
+    printf("%-6s 1 thread  %8.3f s %8.2f ns/op\n", name, t,
+                    t * 1e9 / (2.0 * count));
+
+    /* producer thread to consumer thread */
+    t = now();
+    pthread_create(&tid, NULL, producer, NULL);
+    for (i = 0; i < count; )
+        if (q_deque())
+            i++;
+        else
+            sched_yield();
+    pthread_join(tid, NULL);
+    t = now() - t;
+    printf("%-6s 2 threads %8.3f s %8.2f Mops/s\n", name, t, count / t / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    count = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+
+    m_cirqueue_init(&cq, 1024);
+    use_spsc = 0;
+    run("mutex");
+    m_cirqueue_free(&cq, NULL, NULL);
+
+    m_spscqueue_init(&sq, 1024);
+    use_spsc = 1;
+    run("spsc");
+    m_spscqueue_free(&sq, NULL, NULL);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "heap.h"
+#include "timerwheel.h"
+
+struct element {
+    unsigned long expire;
+    size_t heapidx;
+    struct m_timer timer;
+};
+
+static int cbk_compare(void *elem1, void *elem2, void *udt)
+{
+    struct element *em1 = (struct element *)elem1;
+    struct element *em2 = (struct element *)elem2;
+    if (em1->expire > em2->expire)
+        return 1;
+    else if (em1->expire < em2->expire)
+        return -1;
+    else
+        return 0;
+}
+
+static union m_heapkey cbk_getkey(void *elem, void *udt)
+{
+    union m_heapkey key;
+    key.i = (long long)((struct element *)elem)->expire;
+    return key;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* every 10 timers 9 are cancelled before expire, like connection timeout */
+static void bench_heap(struct element *elems, size_t n, unsigned long span)
+{
+    size_t i = 0;
+    size_t fired = 0;
+    double t = 0;
+    unsigned long tick = 0;
+    struct element *em = NULL;
+    struct m_heap heap;
+
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC | M_HEAP_ARITY4, 1024,
+                    cbk_compare, NULL);
+    m_heap_set_index(&heap, M_HEAP_OFFSET(struct element, heapidx));
+    m_heap_set_key(&heap, M_HEAP_KEY_INT, cbk_getkey);
+
+    t = now();
+    for (i = 0; i < n; i++)
+        m_heap_insert(&heap, &elems[i]);
+    for (i = 0; i < n; i++)
+        if (i % 10)
+            m_heap_remove(&heap, &elems[i]);
+    for (tick = 0; tick <= span; tick++) {
+        while ((em = (struct element *)m_heap_peek(&heap)) != NULL &&
+               em->expire <= tick) {
+            m_heap_pop(&heap);
+            fired++;
+        }
+    }
+    t = now() - t;
+    printf("%-10s n=%-9lu fired=%-8lu %8.3f s %8.2f ns/timer\n", "heap",
+                    (unsigned long)n, (unsigned long)fired, t, t * 1e9 / n);
+    m_heap_free(&heap, NULL, NULL);
+}
+
+static void bench_wheel(struct element *elems, size_t n, unsigned long span)
+{
+    size_t i = 0;
+    size_t fired = 0;
+    double t = 0;
+    struct m_timerwheel tw;
+
+    m_timerwheel_init(&tw, M_TIMER_OFFSET(struct element, timer), 0);
+    for (i = 0; i < n; i++)
+        m_timerwheel_timer_init(&elems[i].timer);
+
+    t = now();
+    for (i = 0; i < n; i++)
+        m_timerwheel_add(&tw, &elems[i], elems[i].expire);
+    for (i = 0; i < n; i++)
+        if (i % 10)
+            m_timerwheel_cancel(&tw, &elems[i]);
+    fired = m_timerwheel_advance(&tw, span, NULL, NULL);
+    t = now() - t;
+    printf("%-10s n=%-9lu fired=%-8lu %8.3f s %8.2f ns/timer\n", "wheel",
+                    (unsigned long)n, (unsigned long)fired, t, t * 1e9 / n);
+    m_timerwheel_free(&tw, NULL, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    int a = 0;
+    size_t i = 0;
+    size_t n = 0;
+    unsigned long span = 100000;
+    struct element *elems = NULL;
+    static const char *defargv[] = {"", "100000", "1000000"};
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    if (argc < 2) {
+        argc = 3;
+        argv = (char **)defargv;
+    }
+
+    for (a = 1; a < argc; a++) {
+        n = (size_t)atol(argv[a]);
+        elems = (struct element *)malloc(sizeof(struct element) * n);
+        srand(9);
+        for (i = 0; i < n; i++)
+            elems[i].expire = 1 + (unsigned long)rand() % span;
+
+        bench_heap(elems, n, span);
+        bench_wheel(elems, n, span);
+        free(elems);
+    }
+
+    return 0;
+}
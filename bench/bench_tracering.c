@@ -0,0 +1,83 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "tracering.h"
+
+#define THREADS 4
+
+static size_t count;
+static struct m_tracering trace;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct m_tracebuf *shared;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* one ring for all threads behind a mutex, the usual shared log */
+static void *locked_writer(void *arg)
+{
+    size_t i = 0;
+    char msg[32];
+
+    memset(msg, 'x', sizeof(msg));
+    for (i = 0; i < count; i++) {
+        pthread_mutex_lock(&lock);
+        m_tracering_write(shared, 1, msg, 8 + i % 24);
+        pthread_mutex_unlock(&lock);
+    }
+
+    return NULL;
+}
+
+static void *own_writer(void *arg)
+{
+    size_t i = 0;
+    char msg[32];
+    struct m_tracebuf *buf = m_tracering_attach(&trace);
+
+    memset(msg, 'x', sizeof(msg));
+    for (i = 0; i < count; i++)
+        m_tracering_write(buf, 1, msg, 8 + i % 24);
+
+    return NULL;
+}
+
+static void bench(const char *name, void *(*writer)(void *))
+{
+    int i = 0;
+    double t = 0;
+    pthread_t tids[THREADS];
+
+    m_tracering_init(&trace, THREADS, 1 << 16);
+    shared = m_tracering_attach(&trace);
+    t = now();
+    for (i = 0; i < THREADS; i++)
+        pthread_create(&tids[i], NULL, writer, NULL);
+    for (i = 0; i < THREADS; i++)
+        pthread_join(tids[i], NULL);
+    t = now() - t;
+    printf("%-7s threads=%d n=%-9lu %8.3f s %8.2f ns/record\n", name,
+                    THREADS, (unsigned long)count, t,
+                    t * 1e9 / (count * THREADS));
+    m_tracering_free(&trace);
+}
+
+int main(int argc, char *argv[])
+{
+    count = argc > 1 ? (size_t)atol(argv[1]) : 5000000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    bench("locked", locked_writer);
+    bench("percpu", own_writer);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "list.h"
+#include "ulist.h"
+
+struct element {
+    int key;
+    struct m_listnode listnode;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void count_cbk(void *elem, void *udt)
+{
+    (*(size_t *)udt)++;
+}
+
+static int find_cbk(void *elem, void *key, void *udt)
+{
+    return ((struct element *)elem)->key == (int)(long)key ? 0 : -1;
+}
+
+/* scan 'count' malloc'ed elements linked in 'shuffle'd or allocate order */
+static void bench(size_t count, size_t cap, int shuffle)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t num = 0;
+    double t[4];
+    struct element **elems = NULL;
+    struct element *temp = NULL;
+    struct m_list list;
+    struct m_ulist ulist;
+
+    elems = (struct element **)malloc(sizeof(struct element *) * count);
+    for (i = 0; i < count; i++) {
+        elems[i] = (struct element *)malloc(sizeof(struct element));
+        elems[i]->key = (int)i;
+    }
+    srand(1);
+    for (i = count - 1; shuffle && i > 0; i--) {
+        j = ((size_t)rand() * RAND_MAX + rand()) % (i + 1);
+        temp = elems[i];
+        elems[i] = elems[j];
+        elems[j] = temp;
+    }
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+    m_ulist_init(&ulist, cap);
+    for (i = 0; i < count; i++) {
+        m_list_append(&list, elems[i]);
+        m_ulist_append(&ulist, elems[i]);
+    }
+
+    t[0] = now();
+    m_list_travarsal(&list, 0, count_cbk, &num);
+    t[0] = now() - t[0];
+    t[1] = now();
+    m_ulist_travarsal(&ulist, 0, count_cbk, &num);
+    t[1] = now() - t[1];
+    /* find touches every element */
+    t[2] = now();
+    m_list_find(&list, (void *)-1L, find_cbk, NULL);
+    t[2] = now() - t[2];
+    t[3] = now();
+    m_ulist_find(&ulist, (void *)-1L, find_cbk, NULL);
+    t[3] = now() - t[3];
+
+    printf("count=%-9lu cap=%-3lu %-8s travarsal %6.2f -> %6.2f ns/elem"
+                    "  find %6.2f -> %6.2f ns/elem\n", (unsigned long)count,
+                    (unsigned long)cap, shuffle ? "shuffle" : "ordered",
+                    t[0] * 1e9 / count, t[1] * 1e9 / count,
+                    t[2] * 1e9 / count, t[3] * 1e9 / count);
+
+    m_ulist_free(&ulist, NULL, NULL);
+    m_list_free(&list, NULL, NULL);
+    for (i = 0; i < count; i++)
+        free(elems[i]);
+    free(elems);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t cap = 0;
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 4000000;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    for (cap = 16; cap <= 64; cap *= 2) {
+        bench(count, cap, 0);
+        bench(count, cap, 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    memory allocator hooks
+*****************************************************/
+
+#ifndef __MINIDS_ALLOCATOR_H__
+#define __MINIDS_ALLOCATOR_H__
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************
+ * @brief   allocator used by container for its own memory, such as heap
+ *          array, never for element, pass it to *_init_alloc(),
+ *          NULL allocator means libc malloc/realloc/free
+ *          NOTE! allocator must outlive the container
+ * @alloc   allocate 'size' bytes, NULL if failed
+ * @realloc resize 'ptr' to 'size' bytes, keep content, 'ptr' may be NULL,
+ *          NULL if failed and 'ptr' is untouched
+ * @free    free 'ptr' from alloc or realloc, 'ptr' may be NULL
+ * @ctx     opaque param pass to callback, such as an arena
+ *          @sample
+ *          void *arena_alloc(size_t size, void *ctx)
+ *          {
+ *              return mallocx(size, MALLOCX_ARENA(*(unsigned *)ctx));
+ *          }
+*********************************************************/
+struct m_allocator {
+    void *(*alloc)(size_t size, void *ctx);
+    void *(*realloc)(void *ptr, size_t size, void *ctx);
+    void (*free)(void *ptr, void *ctx);
+    void *ctx;
+};
+
+#define M_ALLOC(A,SIZE) \
+    ((A) ? (A)->alloc((SIZE), (A)->ctx) : malloc(SIZE))
+#define M_REALLOC(A,PTR,SIZE) \
+    ((A) ? (A)->realloc((PTR), (SIZE), (A)->ctx) : realloc((PTR), (SIZE)))
+#define M_FREE(A,PTR) \
+    ((A) ? (A)->free((PTR), (A)->ctx) : free(PTR))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
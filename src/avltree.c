@@ -2,6 +2,7 @@
 
 
 #include "avltree.h"
+#include "treewalk.h"
 
 #ifndef inline
 #define inline __inline
@@ -428,6 +429,14 @@ void m_avltree_inorder(struct m_avltree *tree,
     return avltree_inorder(tree->offset, tree->root, cbk, udt);
 }
 
+void m_avltree_inorder_prefetch(struct m_avltree *tree,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    if (!tree || !cbk) return;
+
+    M_TREE_INORDER_PREFETCH(struct m_avlnode, tree->root, tree->offset, cbk, udt);
+}
+
 static void avltree_preorder(size_t offset, struct m_avlnode *node,
                     void (*cbk)(void *elem, void *udt), void *udt)
 {
@@ -18,6 +18,9 @@ extern "C" {
 #define M_EUNKNOWN  (-2) /* unknown error */
 #define M_ENOTFOUND (-3) /* not found */
 #define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
 #endif
 /*******************************************************
  * @brief   calculate avlnode offset in element, just use for m_avltree_init()
@@ -190,6 +193,19 @@ void *m_avltree_root(struct m_avltree *tree);
 ********************************************************/
 void m_avltree_inorder(struct m_avltree *tree,
                     void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   orderly traversal avltree like m_avltree_inorder(), but without
+ *          recursion, right child and element of every node are
+ *          prefetched when the node is pushed, so they are in cache when
+ *          the left subtree is done, it helps big trees of cold elements
+ * @tree    avltree instance addr
+ * @cbk     callback function use for return every element
+ * @udt     opaque pram pass to callback
+********************************************************/
+void m_avltree_inorder_prefetch(struct m_avltree *tree,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
 void m_avltree_preorder(struct m_avltree *tree,
                     void (*cbk)(void *elem, void *udt), void *udt);
 void m_avltree_postorder(struct m_avltree *tree,
@@ -0,0 +1,199 @@
+#define _GNU_SOURCE
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "blkqueue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __asm__ __volatile__("pause" ::: "memory")
+#else
+#define CPU_RELAX() __asm__ __volatile__("" ::: "memory")
+#endif
+
+int m_blkqueue_init(struct m_blkqueue *que, size_t maxnum)
+{
+    return m_blkqueue_init_alloc(que, maxnum, NULL);
+}
+
+int m_blkqueue_init_alloc(struct m_blkqueue *que, size_t maxnum,
+                    struct m_allocator *allocator)
+{
+    int ret = 0;
+    if (!que) return M_EINVAL;
+
+    ret = m_mpmcqueue_init_alloc(&que->que, maxnum, allocator);
+    if (ret)
+        return ret;
+    que->spin = M_BLK_SPIN_MIN;
+    que->dataseq = que->datawait = 0;
+    que->roomseq = que->roomwait = 0;
+
+    return 0;
+}
+
+void m_blkqueue_free(struct m_blkqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    if (!que) return;
+
+    m_mpmcqueue_free(&que->que, cbk, udt);
+    que->spin = M_BLK_SPIN_MIN;
+    que->dataseq = que->datawait = 0;
+    que->roomseq = que->roomwait = 0;
+}
+
+/* wake one waiter parked on 'seq', only if one is registered */
+static void blk_notify(int *seq, int *nwait)
+{
+    /* pairs with fence in blk_park, queue update is seen or waiter is */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(nwait, __ATOMIC_RELAXED) > 0) {
+        __atomic_add_fetch(seq, 1, __ATOMIC_RELEASE);
+        syscall(SYS_futex, seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+int m_blkqueue_enque(struct m_blkqueue *que, void *elem)
+{
+    int ret = 0;
+    if (!que) return M_EINVAL;
+
+    ret = m_mpmcqueue_try_enque(&que->que, elem);
+    if (ret == 0)
+        blk_notify(&que->dataseq, &que->datawait);
+
+    return ret;
+}
+
+void *m_blkqueue_deque(struct m_blkqueue *que)
+{
+    void *elem = NULL;
+    if (!que) return NULL;
+
+    elem = m_mpmcqueue_try_deque(&que->que);
+    if (elem)
+        blk_notify(&que->roomseq, &que->roomwait);
+
+    return elem;
+}
+
+/* one try, enqueue 'elem' if 'put', dequeue into 'elem' otherwise */
+static int blk_try(struct m_blkqueue *que, int put, void **elem)
+{
+    if (put)
+        return m_blkqueue_enque(que, *elem) == 0;
+
+    *elem = m_blkqueue_deque(que);
+    return *elem != NULL;
+}
+
+/* spin up to budget, then move budget toward twice the retries used */
+static int blk_spin(struct m_blkqueue *que, int put, void **elem)
+{
+    int i = 0;
+    int ok = 0;
+    int spin = __atomic_load_n(&que->spin, __ATOMIC_RELAXED);
+
+    for (i = 0; i < spin && !(ok = blk_try(que, put, elem)); i++)
+        CPU_RELAX();
+    if (ok)
+        spin += (2 * i - spin) / 8;
+    else
+        spin -= spin / 8;
+    if (spin < M_BLK_SPIN_MIN)
+        spin = M_BLK_SPIN_MIN;
+    if (spin > M_BLK_SPIN_MAX)
+        spin = M_BLK_SPIN_MAX;
+    __atomic_store_n(&que->spin, spin, __ATOMIC_RELAXED);
+
+    return ok;
+}
+
+/********************************************************
+ * @brief   park until queue lets 'put' or get succeed or time is out,
+ *          waiter registers then reads futex word then retries, so a
+ *          notify after the retry changes the word and futex wait
+ *          returns at once
+ * @return  1 succeeded, 0 timed out
+*********************************************************/
+static int blk_park(struct m_blkqueue *que, int put, void **elem,
+                    int timeout)
+{
+    int ok = 0;
+    int val = 0;
+    int expired = 0;
+    int *seq = put ? &que->roomseq : &que->dataseq;
+    int *nwait = put ? &que->roomwait : &que->datawait;
+    long ms = 0;
+    struct timespec now;
+    struct timespec deadline;
+    struct timespec left;
+
+    if (timeout >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    for (;;) {
+        __atomic_add_fetch(nwait, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        val = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        ok = blk_try(que, put, elem);
+        if (!ok && timeout < 0) {
+            syscall(SYS_futex, seq, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+        } else if (!ok) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            ms = (deadline.tv_sec - now.tv_sec) * 1000 +
+                 (deadline.tv_nsec - now.tv_nsec) / 1000000;
+            if (ms <= 0) {
+                expired = 1;
+            } else {
+                left.tv_sec = ms / 1000;
+                left.tv_nsec = (ms % 1000) * 1000000;
+                syscall(SYS_futex, seq, FUTEX_WAIT_PRIVATE, val, &left,
+                            NULL, 0);
+            }
+        }
+        __atomic_sub_fetch(nwait, 1, __ATOMIC_RELAXED);
+        if (ok || expired)
+            break;
+    }
+
+    return ok;
+}
+
+int m_blkqueue_enque_wait(struct m_blkqueue *que, void *elem, int timeout)
+{
+    if (!que || !elem) return M_EINVAL;
+
+    if (blk_spin(que, 1, &elem) || blk_park(que, 1, &elem, timeout))
+        return 0;
+
+    return M_ETOOMANY;
+}
+
+void *m_blkqueue_deque_wait(struct m_blkqueue *que, int timeout)
+{
+    void *elem = NULL;
+    if (!que) return NULL;
+
+    if (blk_spin(que, 0, &elem) || blk_park(que, 0, &elem, timeout))
+        return elem;
+
+    return NULL;
+}
+
+size_t m_blkqueue_num(struct m_blkqueue *que)
+{
+    if (!que) return 0;
+
+    return m_mpmcqueue_num(&que->que);
+}
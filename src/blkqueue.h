@@ -0,0 +1,130 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    blocking queue, spin then park on futex
+*****************************************************/
+
+#ifndef __MINIDS_BLKQUEUE_H__
+#define __MINIDS_BLKQUEUE_H__
+
+#include <stdlib.h>
+
+#include "mpmcqueue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_BLK_SPIN_MIN  16   /* least retries before park */
+#define M_BLK_SPIN_MAX  1024 /* most retries before park */
+
+/********************************************************
+ * @brief   blocking queue struct define
+ *          an m_mpmcqueue plus two futex words, a waiter first retries
+ *          up to 'spin' times, then registers in 'datawait' or
+ *          'roomwait', reads the futex word, retries once more and
+ *          parks, the other side bumps the word and wakes one waiter
+ *          only when a waiter is registered, so while nobody parks no
+ *          syscall is made
+ *          'spin' adapts: it grows toward twice the retries that
+ *          succeeded and shrinks each time spinning ends in a park
+ * @que     lock-free queue of element
+ * @spin    current spin budget, M_BLK_SPIN_MIN to M_BLK_SPIN_MAX
+ * @dataseq futex word, bumped when element is enqueued for a waiter
+ * @datawait numbers of consumer registered to park on 'dataseq'
+ * @roomseq futex word, bumped when slot is freed for a waiter
+ * @roomwait numbers of producer registered to park on 'roomseq'
+*********************************************************/
+struct m_blkqueue {
+    struct m_mpmcqueue que;
+    int spin;
+    char pad0[64];
+    int dataseq;
+    int datawait;
+    char pad1[64];
+    int roomseq;
+    int roomwait;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   initialize queue
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_blkqueue_init(struct m_blkqueue *que, size_t maxnum);
+
+/********************************************************
+ * @brief   initialize queue with a memory allocator
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_blkqueue_init_alloc(struct m_blkqueue *que, size_t maxnum,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue and release its memory, no thread may wait on it
+ * @que     queue instance addr
+ * @cbk     callback of every element left, may be NULL
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_blkqueue_free(struct m_blkqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   enqueue without waiting
+ * @que     queue instance addr
+ * @elem    the new element, not NULL
+ * @return  0 sucess, M_ETOOMANY if queue is full
+********************************************************/
+int m_blkqueue_enque(struct m_blkqueue *que, void *elem);
+
+/********************************************************
+ * @brief   dequeue without waiting
+ * @que     queue instance addr
+ * @return  element addr, NULL if queue is empty
+*********************************************************/
+void *m_blkqueue_deque(struct m_blkqueue *que);
+
+/*******************************************************
+ * @brief   enqueue, wait while queue is full
+ * @que     queue instance addr
+ * @elem    the new element, not NULL
+ * @timeout max wait in milliseconds, -1 wait forever
+ * @return  0 sucess, M_ETOOMANY if timed out
+********************************************************/
+int m_blkqueue_enque_wait(struct m_blkqueue *que, void *elem, int timeout);
+
+/********************************************************
+ * @brief   dequeue, wait while queue is empty
+ * @que     queue instance addr
+ * @timeout max wait in milliseconds, -1 wait forever
+ * @return  element addr, NULL if timed out
+*********************************************************/
+void *m_blkqueue_deque_wait(struct m_blkqueue *que, int timeout);
+
+/********************************************************
+ * @brief   get numbers of element in queue, a snapshot
+ * @que     queue instance addr
+ * @return  numbers of element
+*********************************************************/
+size_t m_blkqueue_num(struct m_blkqueue *que);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
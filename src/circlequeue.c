@@ -1,16 +1,107 @@
 
+#ifdef M_QUEUE_STATS
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
+#include <string.h>
+
 #include "circlequeue.h"
 
+#ifdef M_QUEUE_STATS
+static unsigned long long stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* start timing element at slot 'pos' */
+static void stats_start(struct m_cirqueue *que, size_t pos)
+{
+    que->stats.sampleslot = pos < que->maxnum ? pos : pos - que->maxnum;
+    que->stats.samplets = stats_now();
+}
+
+/* timed element leave, count its dwell if 'dequeued' */
+static void stats_stop(struct m_cirqueue *que, int dequeued)
+{
+    size_t i = 0;
+    unsigned long long dwell = 0;
+
+    if (dequeued) {
+        dwell = stats_now() - que->stats.samplets;
+        for (i = 0; i < M_QUEUE_HIST - 1 && dwell >> (i + 1); i++)
+            ;
+        que->stats.dwell[i]++;
+    }
+    que->stats.sampleslot = (size_t)-1;
+}
+
+/* 'n' elements enqueued from slot 'pos' on, time one in M_QUEUE_SAMPLE */
+static void stats_enter(struct m_cirqueue *que, size_t pos,
+                    size_t n)
+{
+    struct m_questats *st = &que->stats;
+    size_t off = (M_QUEUE_SAMPLE - st->enques % M_QUEUE_SAMPLE) %
+                    M_QUEUE_SAMPLE;
+
+    if (off < n && st->sampleslot == (size_t)-1)
+        stats_start(que, pos + off);
+    st->enques += n;
+    if (que->num > st->highwater)
+        st->highwater = que->num;
+}
+
+/* 'n' elements leave from head, dequeued or covered */
+static void stats_leave(struct m_cirqueue *que, size_t n,
+                    int dequeued)
+{
+    size_t dist = 0;
+    struct m_questats *st = &que->stats;
+
+    if (dequeued)
+        st->deques += n;
+    else
+        st->covers += n;
+    if (st->sampleslot == (size_t)-1)
+        return;
+    /* slots from head to timed element, no division on the hot path */
+    dist = st->sampleslot >= que->head ? st->sampleslot - que->head :
+                    st->sampleslot + que->maxnum - que->head;
+    if (dist < n)
+        stats_stop(que, dequeued);
+}
+
+#define STATS_ENTER(que,pos,n)      stats_enter((que), (pos), (n))
+#define STATS_LEAVE(que,n,deq)      stats_leave((que), (n), (deq))
+#else
+#define STATS_ENTER(que,pos,n)
+#define STATS_LEAVE(que,n,deq)
+#endif
+
 int m_cirqueue_init(struct m_cirqueue *que, size_t maxnum)
+{
+    return m_cirqueue_init_alloc(que, maxnum, NULL);
+}
+
+int m_cirqueue_init_alloc(struct m_cirqueue *que, size_t maxnum,
+                    struct m_allocator *allocator)
 {
     if (!que || maxnum <= 0) return M_EINVAL;
 
-    que->array = (struct m_quenode *)malloc(sizeof(struct m_quenode)*maxnum);
+    que->array = (struct m_quenode *)M_ALLOC(allocator,
+                    sizeof(struct m_quenode) * maxnum);
     if (!que->array)
         return M_EMALLOC;
+    que->allocator = allocator;
     que->head = que->tail = 0;
     que->maxnum = maxnum;
     que->num = 0;
+#ifdef M_QUEUE_STATS
+    memset(&que->stats, 0, sizeof(que->stats));
+    que->stats.sampleslot = (size_t)-1;
+#endif
 
     return 0;
 }
@@ -25,6 +116,11 @@ void m_cirqueue_free(struct m_cirqueue *que,
         if (cbk) cbk(que->array[que->head].elem, udt);
         que->head = (que->head + 1) % que->maxnum;
     }
+    M_FREE(que->allocator, que->array);
+    que->array = NULL;
+    que->head = que->tail = 0;
+    que->maxnum = 0;
+    que->allocator = NULL;
 }
 
 int m_cirqueue_enque(struct m_cirqueue *que, void *elem,
@@ -35,14 +131,16 @@ int m_cirqueue_enque(struct m_cirqueue *que, void *elem,
     /* if queue is full, dequeue one element */
     if (que->num == que->maxnum) {
         if (cover) cover(que->array[que->head].elem, udt);
+        STATS_LEAVE(que, 1, 0);
         que->head = (que->head + 1) % que->maxnum;
         que->num--;
     }
 
     /* enqueue */
     que->array[que->tail].elem = elem;
-    que->tail = (que->tail + 1) % que->maxnum;
     que->num++;
+    STATS_ENTER(que, que->tail, 1);
+    que->tail = (que->tail + 1) % que->maxnum;
 
     return 0;
 }
@@ -57,9 +155,108 @@ void *m_cirqueue_deque(struct m_cirqueue *que)
         return NULL;
 
     /* dequeue */
-    em = que->array[que->tail].elem;
-    que->tail = (que->tail + 1) % que->maxnum;
+    em = que->array[que->head].elem;
+    STATS_LEAVE(que, 1, 1);
+    que->head = (que->head + 1) % que->maxnum;
     que->num--;
 
     return em;
 }
+
+/* copy 'n' pointers between array, from slot 'pos' on, and 'elems',
+ * split at the wrap point, m_quenode is a bare pointer so spans are
+ * plain memcpy */
+static void cirqueue_copy(struct m_cirqueue *que, size_t pos, void **elems,
+                    size_t n, int toque)
+{
+    size_t first = que->maxnum - pos;
+    if (first > n)
+        first = n;
+
+    if (toque) {
+        memcpy(&que->array[pos], elems, sizeof(void *) * first);
+        memcpy(&que->array[0], elems + first, sizeof(void *) * (n - first));
+    } else {
+        memcpy(elems, &que->array[pos], sizeof(void *) * first);
+        memcpy(elems + first, &que->array[0], sizeof(void *) * (n - first));
+    }
+}
+
+int m_cirqueue_enque_bulk(struct m_cirqueue *que, void **elems, size_t n,
+                    void (*cover)(void *elem, void *udt), void *udt)
+{
+    size_t i = 0;
+    size_t evict = 0;
+    if (!que || (!elems && n)) return M_EINVAL;
+
+    /* covered old element */
+    if (que->num + n > que->maxnum) {
+        evict = que->num + n - que->maxnum;
+        if (evict > que->num)
+            evict = que->num;
+        STATS_LEAVE(que, evict, 0);
+        for (i = 0; i < evict; i++) {
+            if (cover) cover(que->array[que->head].elem, udt);
+            if (++que->head == que->maxnum)
+                que->head = 0;
+        }
+        que->num -= evict;
+    }
+
+    /* covered element of this batch, only when batch exceed queue */
+    if (n > que->maxnum) {
+        for (i = 0; i < n - que->maxnum; i++)
+            if (cover) cover(elems[i], udt);
+#ifdef M_QUEUE_STATS
+        que->stats.enques += n - que->maxnum;
+        que->stats.covers += n - que->maxnum;
+#endif
+        elems += n - que->maxnum;
+        n = que->maxnum;
+    }
+
+    cirqueue_copy(que, que->tail, elems, n, 1);
+    que->num += n;
+    STATS_ENTER(que, que->tail, n);
+    que->tail += n;
+    if (que->tail >= que->maxnum)
+        que->tail -= que->maxnum;
+
+    return 0;
+}
+
+size_t m_cirqueue_deque_bulk(struct m_cirqueue *que, void **out, size_t n)
+{
+    if (!que || !out) return 0;
+
+    if (n > que->num)
+        n = que->num;
+    cirqueue_copy(que, que->head, out, n, 0);
+    STATS_LEAVE(que, n, 1);
+    que->head += n;
+    if (que->head >= que->maxnum)
+        que->head -= que->maxnum;
+    que->num -= n;
+
+    return n;
+}
+
+#ifdef M_QUEUE_STATS
+int m_cirqueue_stats(struct m_cirqueue *que, struct m_questats *stats)
+{
+    if (!que || !stats) return M_EINVAL;
+
+    *stats = que->stats;
+
+    return 0;
+}
+
+void m_cirqueue_stats_reset(struct m_cirqueue *que)
+{
+    if (!que) return;
+
+    memset(&que->stats, 0, sizeof(que->stats));
+    que->stats.sampleslot = (size_t)-1;
+    que->stats.highwater = que->num;
+}
+#endif
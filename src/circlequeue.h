@@ -8,6 +8,8 @@
 
 #include <stdlib.h>
 
+#include "allocator.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,12 +29,44 @@ struct m_quenode {
     void *elem;
 };
 
+#ifdef M_QUEUE_STATS
+#define M_QUEUE_HIST    32  /* dwell histogram buckets */
+#define M_QUEUE_SAMPLE  64  /* one enqueue in M_QUEUE_SAMPLE is timed */
+
+/********************************************************
+ * @brief   queue statistics, compiled in only with -DM_QUEUE_STATS
+ *          ('make QUEUE_STATS=1'), layout of m_cirqueue depends on it so
+ *          build every user of the queue with the same flag
+ * @enques  numbers of element enqueued
+ * @deques  numbers of element dequeued
+ * @covers  numbers of element covered by enqueue on full queue
+ * @highwater max numbers of element ever in queue
+ * @dwell   sampled enqueue to dequeue time, dwell[i] counts samples of
+ *          [2^i, 2^(i+1)) ns, a covered sample is dropped
+ * @sampleslot slot of the element being timed, -1 if none
+ * @samplets enqueue time of timed element in ns
+*********************************************************/
+struct m_questats {
+    size_t enques;
+    size_t deques;
+    size_t covers;
+    size_t highwater;
+    size_t dwell[M_QUEUE_HIST];
+    size_t sampleslot;
+    unsigned long long samplets;
+};
+#endif
+
 struct m_cirqueue {
     struct m_quenode *array;
     size_t head;
     size_t tail;
     size_t maxnum;
     size_t num;
+    struct m_allocator *allocator;
+#ifdef M_QUEUE_STATS
+    struct m_questats stats;
+#endif
 };
 
 /********************************************************
@@ -43,8 +77,19 @@ struct m_cirqueue {
 *********************************************************/
 int m_cirqueue_init(struct m_cirqueue *que, size_t maxnum);
 
+/********************************************************
+ * @brief   initialize queue with a memory allocator
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_cirqueue_init_alloc(struct m_cirqueue *que, size_t maxnum,
+                    struct m_allocator *allocator);
+
 /*******************************************************
- * @brief   reset queue, free memory by callback 'free'
+ * @brief   reset queue and release its memory, free element by
+ *          callback 'free'
  * @que     queue instance addr
  * @free    memory free callback, iterate all element
  *          NOTE! if NULL may cause memory leak
@@ -95,6 +140,47 @@ int m_cirqueue_enque(struct m_cirqueue *que, void *elem,
 *********************************************************/
 void *m_cirqueue_deque(struct m_cirqueue *que);
 
+/*******************************************************
+ * @brief   enqueue 'n' elements in order, copied by at most two spans,
+ *          same as calling m_cirqueue_enque() 'n' times: if queue get
+ *          full, oldest element, maybe of this batch, is covered
+ * @que     queue instance addr
+ * @elems   array of new element
+ * @n       numbers of new element
+ * @cover   element cover callback, called once per covered element in
+ *          order, see m_cirqueue_enque()
+ * @udt     opaque param pass to callback
+ * @return  0 sucess, M_Exxx otherwise
+********************************************************/
+int m_cirqueue_enque_bulk(struct m_cirqueue *que, void **elems, size_t n,
+                    void (*cover)(void *elem, void *udt), void *udt);
+
+/********************************************************
+ * @brief   dequeue up to 'n' elements in order, copied by at most two
+ *          spans
+ * @que     queue instance addr
+ * @out     array of at least 'n' slots, receive dequeued element
+ * @n       max numbers of element to dequeue
+ * @return  numbers of dequeued element
+*********************************************************/
+size_t m_cirqueue_deque_bulk(struct m_cirqueue *que, void **out, size_t n);
+
+#ifdef M_QUEUE_STATS
+/********************************************************
+ * @brief   get a copy of queue statistics
+ * @que     queue instance addr
+ * @stats   receive statistics
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_cirqueue_stats(struct m_cirqueue *que, struct m_questats *stats);
+
+/********************************************************
+ * @brief   clear queue statistics, high-water restart from current depth
+ * @que     queue instance addr
+*********************************************************/
+void m_cirqueue_stats_reset(struct m_cirqueue *que);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
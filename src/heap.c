@@ -1,80 +1,477 @@
 
+#include <string.h>
+
 #include "heap.h"
 
-#define PARENT(i) ((i - 1) / 2)
-#define LCHILD(i) ((2 * i) + 1)
-#define RCHILD(i) ((2 * i) + 2)
-
-#define SHIFT(a,b) \
-    do { \
-        void *tmp = NULL; \
-        tmp = heap->array[a].elem; \
-        heap->array[a].elem = heap->array[b].elem; \
-        heap->array[b].elem = tmp; \
-    } while (0)
-
-static void shift_up(struct m_heap *heap, size_t i)
-{
-    if (i <= 0) return;
-    while (PARENT(i) >= 0) {
-        int ret = heap->compare(heap->array[PARENT(i)].elem,heap->array[i].elem,
-                            heap->udt);
-        if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-            (ret < 0 && heap->type == M_HEAP_MAX)) {
-            SHIFT(PARENT(i),i);
-            i = PARENT(i);
-            if (i <= 0)
+#define PARENT(heap,i) (((i) - 1) >> (heap)->ashift)
+#define LCHILD(heap,i) (((i) << (heap)->ashift) + 1)
+
+#define CACHELINE 64
+
+/* slot index stored in element, used by index mode */
+#define ELEM2POS(ELEM,OFFSET) ((size_t *)((size_t)(ELEM) + (OFFSET)))
+
+/* 1 if elem1 should be nearer the head than elem2 */
+#define BEFORE(heap,elem1,elem2) \
+    M_HEAP_BEFORE((heap)->type, (heap)->compare(elem1, elem2, (heap)->udt))
+
+/* 1 if element 'em' with cached key 'k' should be above slot 'i' */
+#define BEFORE_SLOT(heap,em,k,i) ((heap)->keys ? \
+    (k) < (heap)->keys[i] : BEFORE(heap, em, (heap)->array[i].elem))
+
+/* key of slot 'i', 0 if heap is not in key mode */
+#define SLOTKEY(heap,i) ((heap)->keys ? (heap)->keys[i] : 0)
+
+/********************************************************
+ * @brief   extract key of element, normalized so that smaller key is
+ *          always nearer the head: double bits are mapped to an ordered
+ *          integer, max-heap keys are inverted
+*********************************************************/
+static long long heap_key(struct m_heap *heap, void *elem)
+{
+    long long key = 0;
+    union m_heapkey k;
+    if (!heap->keys)
+        return 0;
+
+    k = heap->getkey(elem, heap->udt);
+    if (heap->keytype == M_HEAP_KEY_DOUBLE) {
+        memcpy(&key, &k.d, sizeof(key));
+        if (key < 0)
+            key ^= ~((unsigned long long)1 << 63);
+    } else {
+        key = k.i;
+    }
+
+    return heap->type == M_HEAP_MAX ? ~key : key;
+}
+
+static void heap_set(struct m_heap *heap, size_t i, void *elem, long long key)
+{
+    heap->array[i].elem = elem;
+    if (heap->keys)
+        heap->keys[i] = key;
+    if (heap->index)
+        *ELEM2POS(elem, heap->offset) = i;
+}
+
+/* move hole at 'i' up until 'elem' fit in */
+static void shift_up(struct m_heap *heap, size_t i, void *elem, long long key)
+{
+    size_t parent = 0;
+    if (heap->keys) {
+        while (i > 0) {
+            parent = PARENT(heap, i);
+            if (key >= heap->keys[parent])
+                break;
+            heap_set(heap, i, heap->array[parent].elem, heap->keys[parent]);
+            i = parent;
+        }
+    } else {
+        while (i > 0) {
+            parent = PARENT(heap, i);
+            if (!BEFORE(heap, elem, heap->array[parent].elem))
+                break;
+            heap_set(heap, i, heap->array[parent].elem, 0);
+            i = parent;
+        }
+    }
+    heap_set(heap, i, elem, key);
+}
+
+/* move hole at 'i' down until 'elem' fit in */
+static void shift_down(struct m_heap *heap, size_t i, void *elem, long long key)
+{
+    size_t j = 0;
+    size_t end = 0;
+    size_t shift = 0;
+    void *child = NULL;
+    long long *keys = heap->keys;
+    while ((shift = LCHILD(heap, i)) < heap->num) {
+        end = shift + heap->arity;
+        if (end > heap->num)
+            end = heap->num;
+        /* pick the first child of all siblings */
+        if (keys) {
+            for (j = shift + 1; j < end; j++)
+                if (keys[j] < keys[shift])
+                    shift = j;
+            if (keys[shift] >= key)
                 break;
+            heap_set(heap, i, heap->array[shift].elem, keys[shift]);
         } else {
-            break;
+            child = heap->array[shift].elem;
+            for (j = shift + 1; j < end; j++) {
+                if (BEFORE(heap, heap->array[j].elem, child)) {
+                    child = heap->array[j].elem;
+                    shift = j;
+                }
+            }
+            /* comprare parent child */
+            if (!BEFORE(heap, child, elem))
+                break;
+            heap_set(heap, i, child, 0);
         }
+        i = shift;
     }
+    heap_set(heap, i, elem, key);
+}
+
+/* 1 if slot 'i' is on a min level of min-max heap, root level is min */
+static int mm_minlevel(size_t i)
+{
+    int level = 0;
+    for (i++; i > 1; i >>= 1)
+        level++;
+    return !(level & 1);
 }
 
-static void shift_down(struct m_heap *heap, size_t i)
+/* 1 if element 'em' with key 'k' is less ('min' = 1) or greater
+ * ('min' = 0) than element of slot 'i' */
+static int mm_before(struct m_heap *heap, int min, void *em, long long k,
+                    size_t i)
 {
     int ret = 0;
-    size_t shift = 0;
-    while (LCHILD(i) < heap->num) {
-        shift = LCHILD(i);
-        /* compare left right child first */
-        if (RCHILD(i) < heap->num) {
-            ret = heap->compare(heap->array[LCHILD(i)].elem,
-                                heap->array[RCHILD(i)].elem, heap->udt);
-            if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-                (ret < 0 && heap->type == M_HEAP_MAX))
-                shift = RCHILD(i);
+    if (heap->keys)
+        return min ? k < heap->keys[i] : k > heap->keys[i];
+    ret = heap->compare(em, heap->array[i].elem, heap->udt);
+    return min ? ret < 0 : ret > 0;
+}
+
+/* move hole at 'i' up through grandparents of same level kind */
+static void mm_bubble_up(struct m_heap *heap, size_t i, int min,
+                    void *elem, long long key)
+{
+    size_t g = 0;
+    while (i > 2) {
+        g = PARENT(heap, PARENT(heap, i));
+        if (!mm_before(heap, min, elem, key, g))
+            break;
+        heap_set(heap, i, heap->array[g].elem, SLOTKEY(heap, g));
+        i = g;
+    }
+    heap_set(heap, i, elem, key);
+}
+
+/* move hole at 'i' down until 'elem' fit in, the hole goes through
+ * grandchildren, so level kind of hole never changes */
+static void mm_trickle_down(struct m_heap *heap, size_t i,
+                    void *elem, long long key)
+{
+    size_t j = 0;
+    size_t m = 0;
+    size_t end = 0;
+    size_t child = 0;
+    void *tmp = NULL;
+    long long tkey = 0;
+    int min = mm_minlevel(i);
+
+    while ((child = LCHILD(heap, i)) < heap->num) {
+        /* best of children and grandchildren */
+        m = child;
+        if (child + 1 < heap->num && mm_before(heap, min,
+                    heap->array[child + 1].elem, SLOTKEY(heap, child + 1), m))
+            m = child + 1;
+        end = LCHILD(heap, child) + 4;
+        if (end > heap->num)
+            end = heap->num;
+        for (j = LCHILD(heap, child); j < end; j++)
+            if (mm_before(heap, min, heap->array[j].elem, SLOTKEY(heap, j), m))
+                m = j;
+
+        if (!mm_before(heap, !min, elem, key, m))
+            break;
+        heap_set(heap, i, heap->array[m].elem, SLOTKEY(heap, m));
+        i = m;
+        if (m <= child + 1)
+            break;
+
+        /* elem went below its new parent of the other kind, swap them */
+        j = PARENT(heap, m);
+        if (mm_before(heap, !min, elem, key, j)) {
+            tmp = heap->array[j].elem;
+            tkey = SLOTKEY(heap, j);
+            heap_set(heap, j, elem, key);
+            elem = tmp;
+            key = tkey;
+        }
+    }
+    heap_set(heap, i, elem, key);
+}
+
+/* fill hole at 'i' with 'elem' and restore min-max heap order */
+static void mm_fix(struct m_heap *heap, size_t i, void *elem, long long key)
+{
+    size_t p = 0;
+    void *old = NULL;
+    long long okey = 0;
+    int min = mm_minlevel(i);
+
+    if (i > 0) {
+        p = PARENT(heap, i);
+        if (mm_before(heap, !min, elem, key, p)) {
+            /* elem belong to parent's levels, parent element come down */
+            old = heap->array[p].elem;
+            okey = SLOTKEY(heap, p);
+            mm_bubble_up(heap, p, !min, elem, key);
+            mm_trickle_down(heap, i, old, okey);
+            return;
         }
-        /* comprare parent child */
-        ret = heap->compare(heap->array[i].elem,
-                            heap->array[shift].elem, heap->udt);
-        if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-            (ret < 0 && heap->type == M_HEAP_MAX)) {
-            SHIFT(i,shift);
-            i = shift;
+        if (i > 2 && mm_before(heap, min, elem, key,
+                    PARENT(heap, p))) {
+            mm_bubble_up(heap, i, min, elem, key);
+            return;
+        }
+    }
+    mm_trickle_down(heap, i, elem, key);
+}
+
+/* slot of max element of min-max heap, heap is not empty */
+static size_t mm_maxpos(struct m_heap *heap)
+{
+    if (heap->num == 1)
+        return 0;
+    if (heap->num > 2 && mm_before(heap, 0, heap->array[2].elem,
+                    SLOTKEY(heap, 2), 1))
+        return 2;
+    return 1;
+}
+
+/* fill hole at 'i' with 'elem' and restore heap order */
+static void heap_fix(struct m_heap *heap, size_t i, void *elem, long long key)
+{
+    if (heap->type == M_HEAP_MINMAX)
+        mm_fix(heap, i, elem, key);
+    else if (i > 0 && BEFORE_SLOT(heap, elem, key, PARENT(heap, i)))
+        shift_up(heap, i, elem, key);
+    else
+        shift_down(heap, i, elem, key);
+}
+
+static int heap_alloc(struct m_heap *heap, size_t maxnum);
+
+/* halve memory of a mostly empty M_HEAP_SHRINK heap, failure is harmless */
+static void heap_shrink(struct m_heap *heap)
+{
+    size_t newsize = heap->maxnum / 2;
+    if (!(heap->flag & M_HEAP_SHRINK) || heap->num >= heap->maxnum / 4 ||
+        heap->maxnum <= heap->minnum)
+        return;
+
+    if (newsize < heap->minnum)
+        newsize = heap->minnum;
+    heap_alloc(heap, newsize);
+}
+
+/* fill slot 'i' with last element and restore heap order */
+static void heap_delete(struct m_heap *heap, size_t i)
+{
+    void *last = heap->array[--heap->num].elem;
+    long long key = SLOTKEY(heap, heap->num);
+    if (i != heap->num)
+        heap_fix(heap, i, last, key);
+    heap_shrink(heap);
+}
+
+/* remove head, the hole is moved down to a leaf along the first child
+ * path, then last element is sifted up from there, it almost always
+ * stays at the leaf so each level cost arity-1 compares instead of arity */
+static void heap_delete_head(struct m_heap *heap)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t end = 0;
+    size_t shift = 0;
+    void *last = heap->array[--heap->num].elem;
+    long long key = SLOTKEY(heap, heap->num);
+    long long *keys = heap->keys;
+    void *child = NULL;
+
+    if (heap->type == M_HEAP_MINMAX) {
+        if (heap->num > 0)
+            mm_fix(heap, 0, last, key);
+        heap_shrink(heap);
+        return;
+    }
+
+    while ((shift = LCHILD(heap, i)) < heap->num) {
+        end = shift + heap->arity;
+        if (end > heap->num)
+            end = heap->num;
+        if (keys) {
+            for (j = shift + 1; j < end; j++)
+                if (keys[j] < keys[shift])
+                    shift = j;
         } else {
-            break;
+            child = heap->array[shift].elem;
+            for (j = shift + 1; j < end; j++) {
+                if (BEFORE(heap, heap->array[j].elem, child)) {
+                    child = heap->array[j].elem;
+                    shift = j;
+                }
+            }
         }
+        heap_set(heap, i, heap->array[shift].elem, SLOTKEY(heap, shift));
+        i = shift;
+    }
+    if (heap->num > 0)
+        shift_up(heap, i, last, key);
+    heap_shrink(heap);
+}
+
+/* find slot of element, M_ENOTFOUND if not in heap */
+static int heap_locate(struct m_heap *heap, void *elem, size_t *pos)
+{
+    size_t i = 0;
+    if (heap->index) {
+        i = *ELEM2POS(elem, heap->offset);
+        if (i >= heap->num || heap->array[i].elem != elem)
+            return M_ENOTFOUND;
+    } else {
+        for (i = 0; i < heap->num; i++)
+            if (heap->array[i].elem == elem)
+                break;
+        if (i == heap->num)
+            return M_ENOTFOUND;
     }
+    *pos = i;
+    return 0;
+}
+
+/********************************************************
+ * @brief   (re)allocate an array of 'maxnum' items of 'size' bytes,
+ *          first 'num' items are kept, item 1 is aligned to cache line
+ *          so all children of a node, start at LCHILD(i), are in one
+ *          cache line for arity <= 8
+ * @mem     allocated memory, updated
+ * @array   current array inside 'mem'
+ * @return  new array, NULL if failed and nothing changed
+*********************************************************/
+static void *heap_realloc(struct m_allocator *allocator, void **mem,
+                    void *array, size_t num, size_t maxnum, size_t size)
+{
+    size_t off = 0;
+    char *p = NULL;
+    char *aligned = NULL;
+
+    if (*mem)
+        off = (char *)array - (char *)*mem;
+    p = (char *)M_REALLOC(allocator, *mem, size * maxnum + CACHELINE);
+    if (!p)
+        return NULL;
+
+    aligned = (char *)(((size_t)p + size + CACHELINE - 1) &
+                    ~(size_t)(CACHELINE - 1)) - size;
+    if (*mem && aligned - p != off)
+        memmove(aligned, p + off, size * num);
+    *mem = p;
+
+    return aligned;
+}
+
+static int heap_alloc(struct m_heap *heap, size_t maxnum)
+{
+    void *p = NULL;
+
+    p = heap_realloc(heap->allocator, &heap->mem, heap->array, heap->num,
+                    maxnum, sizeof(struct m_heapnode));
+    if (!p)
+        return M_EMALLOC;
+    heap->array = (struct m_heapnode *)p;
+    /* array may be shrunk already, keep maxnum safe if keys failed */
+    if (maxnum < heap->maxnum)
+        heap->maxnum = maxnum;
+
+    if (heap->keys) {
+        p = heap_realloc(heap->allocator, &heap->kmem, heap->keys, heap->num,
+                        maxnum, sizeof(long long));
+        if (!p)
+            return M_EMALLOC;
+        heap->keys = (long long *)p;
+    }
+    heap->maxnum = maxnum;
+
+    return 0;
 }
 
 int m_heap_init(struct m_heap *heap, int type, int flag, size_t maxnum,
                 int (*compare)(void *elem1, void *elem2, void *udt), void *udt)
 {
-    if (!heap || (type != M_HEAP_MIN && type != M_HEAP_MAX) ||
-        (flag !=M_HEAP_NOINC && flag !=M_HEAP_INC) || maxnum <= 0 || !compare)
+    return m_heap_init_alloc(heap, type, flag, maxnum, compare, udt, NULL);
+}
+
+int m_heap_init_alloc(struct m_heap *heap, int type, int flag, size_t maxnum,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt,
+                struct m_allocator *allocator)
+{
+    int ret = 0;
+    if (!heap || (type != M_HEAP_MIN && type != M_HEAP_MAX &&
+        type != M_HEAP_MINMAX) ||
+        (flag & ~(M_HEAP_INC | M_HEAP_SHRINK | M_HEAP_ARITY8 |
+                  M_HEAP_ARITY4)) ||
+        (flag & M_HEAP_ARITY8 && flag & M_HEAP_ARITY4) ||
+        (type == M_HEAP_MINMAX && flag & (M_HEAP_ARITY8 | M_HEAP_ARITY4)) ||
+        maxnum <= 0 || !compare)
         return M_EINVAL;
 
-    heap->array = (struct m_heapnode *)malloc(sizeof(struct m_heapnode)*maxnum);
-    if (heap->array == NULL)
-        return M_EMALLOC;
-    
+    heap->allocator = allocator;
+    heap->maxnum = 0;
+    heap->minnum = maxnum;
+    heap->mem = NULL;
+    heap->array = NULL;
+    heap->kmem = NULL;
+    heap->keys = NULL;
+    heap->num = 0;
+    ret = heap_alloc(heap, maxnum);
+    if (ret)
+        return ret;
+
     heap->type = type;
     heap->flag = flag;
-    heap->maxnum = maxnum;
-    heap->num = 0;
+    if (flag & M_HEAP_ARITY8)
+        heap->ashift = 3;
+    else if (flag & M_HEAP_ARITY4)
+        heap->ashift = 2;
+    else
+        heap->ashift = 1;
+    heap->arity = 1 << heap->ashift;
     heap->compare = compare;
     heap->udt = udt;
+    heap->index = 0;
+    heap->offset = 0;
+    heap->keytype = 0;
+    heap->getkey = NULL;
+
+    return 0;
+}
+
+int m_heap_set_index(struct m_heap *heap, size_t offset)
+{
+    if (!heap || heap->num) return M_EINVAL;
+
+    heap->index = 1;
+    heap->offset = offset;
+
+    return 0;
+}
+
+int m_heap_set_key(struct m_heap *heap, int keytype,
+                    union m_heapkey (*getkey)(void *elem, void *udt))
+{
+    void *p = NULL;
+    if (!heap || heap->num || !getkey ||
+        (keytype != M_HEAP_KEY_INT && keytype != M_HEAP_KEY_DOUBLE))
+        return M_EINVAL;
+
+    if (!heap->keys) {
+        p = heap_realloc(heap->allocator, &heap->kmem, NULL, 0,
+                        heap->maxnum, sizeof(long long));
+        if (!p)
+            return M_EMALLOC;
+        heap->keys = (long long *)p;
+    }
+    heap->keytype = keytype;
+    heap->getkey = getkey;
 
     return 0;
 }
@@ -88,38 +485,138 @@ void m_heap_free(struct m_heap *heap,
     if (cbk)
         for (i = 0; i < heap->num; i++)
             cbk(heap->array[i].elem, udt);
-    free(heap->array);
+    M_FREE(heap->allocator, heap->mem);
+    M_FREE(heap->allocator, heap->kmem);
+    heap->mem = NULL;
     heap->array = NULL;
+    heap->kmem = NULL;
+    heap->keys = NULL;
+    heap->keytype = 0;
+    heap->getkey = NULL;
+    heap->arity = 0;
+    heap->ashift = 0;
     heap->type = 0;
     heap->flag = 0;
     heap->maxnum = 0;
     heap->num = 0;
     heap->compare = NULL;
     heap->udt = NULL;
+    heap->index = 0;
+    heap->offset = 0;
+    heap->minnum = 0;
+    heap->allocator = NULL;
+}
+
+int m_heap_reserve(struct m_heap *heap, size_t num)
+{
+    size_t newsize = 0;
+    if (!heap) return M_EINVAL;
+
+    if (num <= heap->maxnum)
+        return 0;
+    if (!(heap->flag & M_HEAP_INC))
+        return M_ETOOMANY;
+
+    /* reallocate memory, double maxnum until large enough */
+    newsize = heap->maxnum;
+    while (newsize < num)
+        newsize *= 2;
+
+    return heap_alloc(heap, newsize);
 }
 
 int m_heap_insert(struct m_heap *heap, void *elem)
 {
+    int ret = 0;
     if (!heap) return M_EINVAL;
 
     if (heap->num >= heap->maxnum) {
-        if (heap->flag == M_HEAP_NOINC) {
-            return M_ETOOMANY;
-        } else {
-            /* reallocate memory */
-            size_t newsize = heap->maxnum * 2;
-            void *p = realloc(heap->array, sizeof(struct m_heapnode)*newsize);
-            if (!p)
-                return M_EMALLOC;
-            
-            heap->maxnum = newsize;
-            heap->array = (struct m_heapnode *)p;
+        ret = m_heap_reserve(heap, heap->num + 1);
+        if (ret)
+            return ret;
+    }
+
+    if (heap->type == M_HEAP_MINMAX)
+        mm_fix(heap, heap->num++, elem, heap_key(heap, elem));
+    else
+        shift_up(heap, heap->num++, elem, heap_key(heap, elem));
+
+    return 0;
+}
+
+/* restore heap order after elements appended at slot 'from' */
+static void heap_heapify(struct m_heap *heap, size_t from)
+{
+    size_t i = 0;
+    size_t n = heap->num - from;
+    size_t logn = 0;
+
+    for (i = heap->num; i > 1; i >>= heap->ashift)
+        logn++;
+    if (from > 0 && n * logn < heap->num) {
+        /* a few new element, sift up one by one */
+        for (heap->num = from; heap->num < from + n; heap->num++) {
+            i = heap->num;
+            if (heap->type == M_HEAP_MINMAX)
+                mm_fix(heap, i, heap->array[i].elem, SLOTKEY(heap, i));
+            else
+                shift_up(heap, i, heap->array[i].elem, SLOTKEY(heap, i));
         }
+        return;
+    }
+
+    /* floyd bottom-up heapify, O(n) */
+    if (heap->num < 2)
+        return;
+    i = PARENT(heap, heap->num - 1) + 1;
+    while (i-- > 0) {
+        if (heap->type == M_HEAP_MINMAX)
+            mm_trickle_down(heap, i, heap->array[i].elem, SLOTKEY(heap, i));
+        else
+            shift_down(heap, i, heap->array[i].elem, SLOTKEY(heap, i));
     }
+}
+
+int m_heap_build(struct m_heap *heap, void **elems, size_t n)
+{
+    size_t i = 0;
+    int ret = 0;
+    if (!heap || (!elems && n)) return M_EINVAL;
 
-    heap->array[heap->num].elem = elem;
-    shift_up(heap, heap->num);
-    heap->num++;
+    ret = m_heap_reserve(heap, heap->num + n);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < n; i++)
+        heap_set(heap, heap->num + i, elems[i], heap_key(heap, elems[i]));
+    heap->num += n;
+    heap_heapify(heap, heap->num - n);
+
+    return 0;
+}
+
+int m_heap_merge(struct m_heap *dst, struct m_heap *src)
+{
+    size_t i = 0;
+    int ret = 0;
+    if (!dst || !src || dst == src || dst->type != src->type ||
+        dst->compare != src->compare || dst->udt != src->udt)
+        return M_EINVAL;
+
+    ret = m_heap_reserve(dst, dst->num + src->num);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < src->num; i++) {
+        void *elem = src->array[i].elem;
+        if (dst->keytype == src->keytype && dst->getkey == src->getkey)
+            heap_set(dst, dst->num + i, elem, SLOTKEY(src, i));
+        else
+            heap_set(dst, dst->num + i, elem, heap_key(dst, elem));
+    }
+    dst->num += src->num;
+    heap_heapify(dst, dst->num - src->num);
+    src->num = 0;
 
     return 0;
 }
@@ -139,64 +636,175 @@ void *m_heap_pop(struct m_heap *heap)
     if (heap->num <= 0) return NULL;
 
     elem = heap->array[0].elem;
-    heap->array[0].elem = heap->array[heap->num - 1].elem;
-    heap->num--;
-    shift_down(heap, 0);
+    heap_delete_head(heap);
 
     return elem;
 }
 
+void *m_heap_peek_min(struct m_heap *heap)
+{
+    if (!heap || heap->type == M_HEAP_MAX) return NULL;
+
+    return m_heap_peek(heap);
+}
+
+void *m_heap_peek_max(struct m_heap *heap)
+{
+    if (!heap || heap->type == M_HEAP_MIN) return NULL;
+    if (heap->num <= 0) return NULL;
+
+    if (heap->type == M_HEAP_MINMAX)
+        return heap->array[mm_maxpos(heap)].elem;
+    return heap->array[0].elem;
+}
+
+void *m_heap_pop_min(struct m_heap *heap)
+{
+    if (!heap || heap->type == M_HEAP_MAX) return NULL;
+
+    return m_heap_pop(heap);
+}
+
+void *m_heap_pop_max(struct m_heap *heap)
+{
+    size_t i = 0;
+    void *elem = NULL;
+    if (!heap || heap->type == M_HEAP_MIN) return NULL;
+    if (heap->num <= 0) return NULL;
+
+    if (heap->type != M_HEAP_MINMAX)
+        return m_heap_pop(heap);
+    i = mm_maxpos(heap);
+    elem = heap->array[i].elem;
+    heap_delete(heap, i);
+
+    return elem;
+}
+
+size_t m_heap_pop_n(struct m_heap *heap, void **out, size_t n)
+{
+    size_t i = 0;
+    if (!heap || !out) return 0;
+
+    for (i = 0; i < n && heap->num > 0; i++) {
+        out[i] = heap->array[0].elem;
+        heap_delete_head(heap);
+    }
+
+    return i;
+}
+
+void *m_heap_replace(struct m_heap *heap, void *elem)
+{
+    void *head = NULL;
+    if (!heap) return NULL;
+
+    if (heap->num <= 0)
+        return m_heap_insert(heap, elem) ? elem : NULL;
+
+    head = heap->array[0].elem;
+    if (heap->type == M_HEAP_MINMAX)
+        mm_fix(heap, 0, elem, heap_key(heap, elem));
+    else
+        shift_down(heap, 0, elem, heap_key(heap, elem));
+
+    return head;
+}
+
+void *m_heap_offer(struct m_heap *heap, void *elem)
+{
+    size_t i = 0;
+    long long key = 0;
+    void *head = NULL;
+    if (!heap) return elem;
+
+    if (heap->num < heap->maxnum) {
+        m_heap_insert(heap, elem);
+        return NULL;
+    }
+
+    key = heap_key(heap, elem);
+    if (heap->type == M_HEAP_MINMAX) {
+        /* full, elem must beat the max to be kept */
+        i = mm_maxpos(heap);
+        if (!mm_before(heap, 1, elem, key, i))
+            return elem;
+        head = heap->array[i].elem;
+        mm_fix(heap, i, elem, key);
+        return head;
+    }
+
+    /* full, elem must beat the head to be kept */
+    if (heap->keys ? heap->keys[0] >= key :
+        !BEFORE(heap, heap->array[0].elem, elem))
+        return elem;
+
+    head = heap->array[0].elem;
+    shift_down(heap, 0, elem, key);
+
+    return head;
+}
+
 int m_heap_remove(struct m_heap *heap, void *elem)
 {
     size_t i = 0;
-    int ret = 0;
-    if (!heap) return M_EINVAL;
+    if (!heap || !elem) return M_EINVAL;
 
     /* find elem position */
-    for (i = 0; i < heap->num; i++) {
-        ret = heap->compare(heap->array[i].elem, elem, heap->udt);
-        if (ret == 0)
-            break;
+    if (heap->index) {
+        if (heap_locate(heap, elem, &i))
+            return M_ENOTFOUND;
+    } else {
+        for (i = 0; i < heap->num; i++)
+            if (heap->compare(heap->array[i].elem, elem, heap->udt) == 0)
+                break;
+        if (i == heap->num)
+            return M_ENOTFOUND;
     }
-    if (i == heap->num)
+
+    heap_delete(heap, i);
+
+    return 0;
+}
+
+int m_heap_update(struct m_heap *heap, void *elem)
+{
+    size_t i = 0;
+    if (!heap || !elem) return M_EINVAL;
+
+    if (heap_locate(heap, elem, &i))
         return M_ENOTFOUND;
-    
-    heap->array[i].elem = heap->array[heap->num - 1].elem;
-    heap->num--;
-    if (i > 0 && PARENT(i) <= heap->num) {
-        ret = heap->compare(heap->array[PARENT(i)].elem,
-                            heap->array[i].elem, heap->udt);
-        if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-            (ret < 0 && heap->type == M_HEAP_MAX)) {
-            shift_up(heap, i);
-            return 0;
-        }
-    }
-    shift_down(heap, i);
+
+    heap_fix(heap, i, elem, heap_key(heap, elem));
 
     return 0;
 }
 
 int m_heap_judge(struct m_heap *heap) {
     size_t i = 0;
-    int ret = 0;
+    int min = 0;
+    void *em = NULL;
     if (!heap) return -1;
-    
+
     for (i = 0; i < heap->num; i++) {
-        if (LCHILD(i) < heap->num) {
-            ret = heap->compare(heap->array[i].elem,
-                                heap->array[LCHILD(i)].elem, heap->udt);
-            if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-                (ret < 0 && heap->type == M_HEAP_MAX))
+        if (heap->type == M_HEAP_MINMAX) {
+            min = mm_minlevel(i);
+            em = heap->array[i].elem;
+            if (i > 0 && mm_before(heap, !min, em, SLOTKEY(heap, i),
+                        PARENT(heap, i)))
                 return -1;
-        }
-        if (RCHILD(i) < heap->num) {
-            ret = heap->compare(heap->array[i].elem,
-                                heap->array[RCHILD(i)].elem, heap->udt);
-            if ((ret > 0 && heap->type == M_HEAP_MIN) ||
-                (ret < 0 && heap->type == M_HEAP_MAX))
+            if (i > 2 && mm_before(heap, min, em, SLOTKEY(heap, i),
+                        PARENT(heap, PARENT(heap, i))))
                 return -1;
+        } else if (i > 0 && BEFORE_SLOT(heap, heap->array[i].elem,
+                    SLOTKEY(heap, i), PARENT(heap, i))) {
+            return -1;
         }
+        if (heap->keys && heap->keys[i] != heap_key(heap, heap->array[i].elem))
+            return -1;
+        if (heap->index &&
+            *ELEM2POS(heap->array[i].elem, heap->offset) != i)
+            return -1;
     }
 
     return 0;
@@ -1,6 +1,6 @@
 /****************************************************
 * Copyright (c) 2019 dangqian All rights reserved.
-* @brief    min-heap / max-heap
+* @brief    min-heap / max-heap / min-max heap
 *****************************************************/
 
 #ifndef __MINIDS_HEAP_H__
@@ -8,6 +8,8 @@
 
 #include <stdlib.h>
 
+#include "allocator.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,23 +27,62 @@ extern "C" {
 
 #define M_HEAP_MIN 0 /* min-heap */
 #define M_HEAP_MAX 1 /* max-heap */
+#define M_HEAP_MINMAX 2 /* min-max heap, both ends O(1) peek */
 #define M_HEAP_INC      1 /* auto incrementally */
 #define M_HEAP_NOINC    0 /* no increment */
+#define M_HEAP_SHRINK   2 /* halve memory when mostly empty */
+#define M_HEAP_ARITY2   0x00 /* binary heap, default */
+#define M_HEAP_ARITY4   0x10 /* 4-ary heap */
+#define M_HEAP_ARITY8   0x20 /* 8-ary heap */
+
+/*******************************************************
+ * @brief   calculate heap index offset in element, just use for
+ *          m_heap_set_index()
+ * @TYPE    element type
+ * @MEMBER  size_t member of element, heap store element slot in it
+ * @sample  struct element {
+ *              int key;
+ *              size_t heapidx;
+ *          }
+ *          M_HEAP_OFFSET(struct element, heapidx)
+********************************************************/
+#define M_HEAP_OFFSET(TYPE, MEMBER) ((size_t)&((TYPE *)0)->MEMBER)
+
+#define M_HEAP_KEY_INT      1 /* cached key is 64-bit integer */
+#define M_HEAP_KEY_DOUBLE   2 /* cached key is double */
 
 struct m_heapnode {
     void *elem;
 };
 
+/* sort key of element, see m_heap_set_key() */
+union m_heapkey {
+    long long i;
+    double d;
+};
+
 /********************************************************
  * @brief   heap struct define
- * @type    M_HEAP_MIN or M_HEAP_MAX
- * @flag    M_HEAP_NOINC or M_HEAP_INC
+ * @type    M_HEAP_MIN, M_HEAP_MAX or M_HEAP_MINMAX
+ *          MINMAX: levels alternate between min and max, root level is
+ *          min, so min is the root and max is one of its children,
+ *          m_heap_peek/pop serve min, see m_heap_pop_max()
+ * @flag    M_HEAP_NOINC or M_HEAP_INC, or'ed with M_HEAP_SHRINK and
+ *          M_HEAP_ARITYx
  *          NOINC: when reach maxnum, insert will failed and return M_ETOOMANY
  *          INC: when reach maxnum, insert will free old allocated memory
  *          reallocate double maxnum memory and insert new element
+ *          SHRINK: when remove make num below 1/4 maxnum, memory is
+ *          halved, never below the initial maxnum
+ *          ARITYx: children number of every node, 2 (default), 4 or 8,
+ *          children of a node are placed in one cache line, a higher
+ *          arity makes tree lower and sifts touch less cache lines
  * @maxnum  max numbers of element in heap, if M_HEAP_INC is set, will auto
  *          double increment
  * @num     counts of element in heap
+ * @arity   children number of every node
+ * @ashift  log2(arity)
+ * @mem     allocated memory, array is aligned inside it
  * @array   memory to store element
  * @compare callback function compare two element sequence
  *          @sample
@@ -57,22 +98,42 @@ struct m_heapnode {
  *                  return 0;
  *          }
  * @udt     opaque param pass to callback
+ * @index   1 if element slot is stored back in element, see m_heap_set_index
+ * @offset  slot index offset in element
+ * @keytype 0, M_HEAP_KEY_INT or M_HEAP_KEY_DOUBLE, see m_heap_set_key
+ * @kmem    allocated memory, keys is aligned inside it
+ * @keys    cached key of every slot, parallel to array
+ * @getkey  callback extract sort key of element
+ * @minnum  initial maxnum, M_HEAP_SHRINK never go below it
+ * @allocator memory allocator of array and keys, NULL for libc
 *********************************************************/
 struct m_heap {
     int type;
     int flag;
     size_t maxnum;
     size_t num;
+    int arity;
+    int ashift;
+    void *mem;
     struct m_heapnode *array;
     int (*compare)(void *elem1, void *elem2, void *udt);
     void *udt;
+    int index;
+    size_t offset;
+    int keytype;
+    void *kmem;
+    long long *keys;
+    union m_heapkey (*getkey)(void *elem, void *udt);
+    size_t minnum;
+    struct m_allocator *allocator;
 };
 
 /********************************************************
  * @brief   initialize heap
  * @heap    heap instance addr
- * @type    M_HEAP_MIN or M_HEAP_MAX
- * @flag    M_HEAP_NOINC or M_HEAP_INC
+ * @type    M_HEAP_MIN, M_HEAP_MAX or M_HEAP_MINMAX
+ * @flag    M_HEAP_NOINC or M_HEAP_INC, or'ed with M_HEAP_SHRINK and
+ *          M_HEAP_ARITY2/4/8, M_HEAP_MINMAX is binary only
  * @maxnum  max numbers of element in heap
  * @compare callback function compare two element sequence
  * @udt     opaque param pass to callback
@@ -81,6 +142,55 @@ struct m_heap {
 int m_heap_init(struct m_heap *heap, int type, int flag, size_t maxnum,
                 int (*compare)(void *elem1, void *elem2, void *udt), void *udt);
 
+/********************************************************
+ * @brief   initialize heap with a memory allocator, see m_heap_init()
+ * @allocator allocator of heap memory, NULL for libc, must outlive heap
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_heap_init_alloc(struct m_heap *heap, int type, int flag, size_t maxnum,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt,
+                struct m_allocator *allocator);
+
+/********************************************************
+ * @brief   switch heap to index mode, heap store every element's array
+ *          slot into element, m_heap_remove() and m_heap_update() find
+ *          element by its identity in O(1) then cost O(log n)
+ * @heap    heap instance addr, must be empty and not M_HEAP_DEFINE one
+ * @offset  offset of size_t member in element, M_HEAP_OFFSET()
+ * @return  0 success, M_EXXX otherwise
+ * @sample  struct element {
+ *              int key;
+ *              size_t heapidx;
+ *          }
+ *          m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC, 64, compare, NULL);
+ *          m_heap_set_index(&heap, M_HEAP_OFFSET(struct element, heapidx));
+*********************************************************/
+int m_heap_set_index(struct m_heap *heap, size_t offset);
+
+/********************************************************
+ * @brief   switch heap to key mode, a fixed-width sort key is extracted
+ *          once when element enter heap and stored in a contiguous array
+ *          beside element pointers, sifts compare cached keys and never
+ *          touch element or call compare
+ * @heap    heap instance addr, must be empty and not M_HEAP_DEFINE one
+ * @keytype M_HEAP_KEY_INT or M_HEAP_KEY_DOUBLE
+ * @getkey  callback return sort key of element, set 'i' for
+ *          M_HEAP_KEY_INT or 'd' for M_HEAP_KEY_DOUBLE
+ *          NOTE! if key of an element changed, m_heap_update() it
+ *          @sample
+ *          union m_heapkey getkey(void *elem, void *udt)
+ *          {
+ *              union m_heapkey key;
+ *              key.i = ((struct element *)elem)->key;
+ *              return key;
+ *          }
+ * @return  0 success, M_EXXX otherwise
+ * NOTE!    element order is defined by key only, compare callback is
+ *          only used by m_heap_remove() when index mode is not set
+*********************************************************/
+int m_heap_set_key(struct m_heap *heap, int keytype,
+                    union m_heapkey (*getkey)(void *elem, void *udt));
+
 /*******************************************************
  * @brief   reset heap, free memory by 'cbk_free'
  * @heap    heap instance addr
@@ -109,6 +219,35 @@ void m_heap_free(struct m_heap *heap,
 ********************************************************/
 int m_heap_insert(struct m_heap *heap, void *elem);
 
+/*******************************************************
+ * @brief   make sure heap can hold 'num' elements without reallocate
+ * @heap    heap instance addr
+ * @num     wanted capacity
+ * @return  0 sucess, M_ETOOMANY if M_HEAP_NOINC and num > maxnum,
+ *          M_Exxx otherwise
+********************************************************/
+int m_heap_reserve(struct m_heap *heap, size_t num);
+
+/*******************************************************
+ * @brief   insert n elements into heap at once, elements are appended
+ *          then heap is rebuilt bottom-up in O(num + n), if heap already
+ *          hold much more elements than n, they are sifted up one by one
+ * @heap    heap instance addr
+ * @elems   array of new elements
+ * @n       numbers of new elements
+ * @return  0 sucess, M_Exxx otherwise, heap is unchanged on failure
+********************************************************/
+int m_heap_build(struct m_heap *heap, void **elems, size_t n);
+
+/*******************************************************
+ * @brief   move all elements of 'src' into 'dst', O(dst.num + src.num)
+ * @dst     heap instance addr, receive elements
+ * @src     heap instance addr, become empty if success, same type
+ *          compare and udt as dst
+ * @return  0 sucess, M_Exxx otherwise, both heaps are unchanged on failure
+********************************************************/
+int m_heap_merge(struct m_heap *dst, struct m_heap *src);
+
 /********************************************************
  * @brief   peek heap head
  * @heap    heap instance addr
@@ -123,14 +262,88 @@ void *m_heap_peek(struct m_heap *heap);
 *********************************************************/
 void *m_heap_pop(struct m_heap *heap);
 
+/********************************************************
+ * @brief   peek min element, O(1)
+ * @heap    heap instance addr, M_HEAP_MIN or M_HEAP_MINMAX
+ * @return  min element, NULL if empty or heap is M_HEAP_MAX
+*********************************************************/
+void *m_heap_peek_min(struct m_heap *heap);
+
+/********************************************************
+ * @brief   peek max element, O(1)
+ * @heap    heap instance addr, M_HEAP_MAX or M_HEAP_MINMAX
+ * @return  max element, NULL if empty or heap is M_HEAP_MIN
+*********************************************************/
+void *m_heap_peek_max(struct m_heap *heap);
+
+/********************************************************
+ * @brief   pop min element, O(log n)
+ * @heap    heap instance addr, M_HEAP_MIN or M_HEAP_MINMAX
+ * @return  min element, NULL if empty or heap is M_HEAP_MAX
+*********************************************************/
+void *m_heap_pop_min(struct m_heap *heap);
+
+/********************************************************
+ * @brief   pop max element, O(log n)
+ * @heap    heap instance addr, M_HEAP_MAX or M_HEAP_MINMAX
+ * @return  max element, NULL if empty or heap is M_HEAP_MIN
+*********************************************************/
+void *m_heap_pop_max(struct m_heap *heap);
+
+/********************************************************
+ * @brief   pop up to 'n' heap head in order, cheaper than calling
+ *          m_heap_pop() 'n' times
+ * @heap    heap instance addr
+ * @out     array of at least 'n' slots, receive popped element
+ * @n       max numbers of element to pop
+ * @return  numbers of popped element
+*********************************************************/
+size_t m_heap_pop_n(struct m_heap *heap, void **out, size_t n);
+
+/********************************************************
+ * @brief   pop heap head and insert 'elem' in one sift, cheaper than
+ *          m_heap_pop() then m_heap_insert()
+ * @heap    heap instance addr
+ * @elem    the new element
+ * @return  old heap head element, NULL if heap was empty, or 'elem'
+ *          itself if heap was empty and it can not be inserted
+*********************************************************/
+void *m_heap_replace(struct m_heap *heap, void *elem);
+
+/********************************************************
+ * @brief   bounded top-K insert, heap keep at most 'maxnum' element,
+ *          when full, 'elem' replace the head only if head is before
+ *          'elem', so a rejected element cost one compare
+ *          e.g. M_HEAP_MIN heap keep the 'maxnum' largest element of
+ *          a stream, the smallest kept one is the head
+ *          M_HEAP_MINMAX heap keep the 'maxnum' smallest element, a new
+ *          element evict the max one, min is still served by pop
+ * @heap    heap instance addr, M_HEAP_NOINC is expected
+ * @elem    the new element
+ * @return  NULL if heap was not full, the evicted head, or 'elem'
+ *          itself if it is rejected
+*********************************************************/
+void *m_heap_offer(struct m_heap *heap, void *elem);
+
 /*******************************************************
  * @brief   remove an new element from heap
  * @heap    heap instance addr
- * @elem    the element
+ * @elem    the element, in index mode it must be the element itself,
+ *          otherwise the first element compare equal with it is removed
  * @return  0 sucess, M_Exxx otherwise
 ********************************************************/
 int m_heap_remove(struct m_heap *heap, void *elem);
 
+/*******************************************************
+ * @brief   restore heap order after key of an element changed
+ *          (increase-key / decrease-key), O(log n) in index mode,
+ *          otherwise element is found by identity in O(n)
+ * @heap    heap instance addr
+ * @elem    the element already in heap, key modified by caller
+ * @return  0 sucess, M_Exxx otherwise
+********************************************************/
+int m_heap_update(struct m_heap *heap, void *elem);
+
 /********************************************************
  * @brief   judge a m_heap is min-heap/max-heap
  * @heap    heap instance addr
@@ -139,6 +352,131 @@ int m_heap_remove(struct m_heap *heap, void *elem);
 *********************************************************/
 int m_heap_judge(struct m_heap *heap);
 
+#if defined(__GNUC__)
+#define M_HEAP_INLINE static __inline__
+#elif defined(_MSC_VER)
+#define M_HEAP_INLINE static __inline
+#else
+#define M_HEAP_INLINE static
+#endif
+
+/* 1 if compare result 'RET' of (a, b) means a should be nearer the head */
+#define M_HEAP_BEFORE(TYPE,RET) \
+                    ((TYPE) == M_HEAP_MIN ? (RET) < 0 : (RET) > 0)
+
+/********************************************************
+ * @brief   define a type specialized heap, all compare are expanded
+ *          inline instead of calling through heap->compare
+ * @NAME    prefix of generated functions
+ * @ETYPE   element type, generated functions take and return 'ETYPE *'
+ * @CMP     function or function-like macro CMP(ETYPE *a, ETYPE *b),
+ *          return value same as compare callback of m_heap_init()
+ * @TYPE    M_HEAP_MIN or M_HEAP_MAX
+ * @sample  #define elem_cmp(a,b) (((a)->key > (b)->key)-((a)->key < (b)->key))
+ *          M_HEAP_DEFINE(eheap, struct element, elem_cmp, M_HEAP_MIN)
+ *
+ *          struct m_heap heap;
+ *          eheap_init(&heap, M_HEAP_INC, 100);
+ *          eheap_insert(&heap, elem);
+ *          elem = eheap_peek(&heap);
+ *          elem = eheap_pop(&heap);
+ *          eheap_remove(&heap, elem);
+ *          m_heap_free(&heap, cbk_free, NULL);
+ * NOTE!    heap must initialized by NAME_init(), it is a normal binary
+ *          m_heap, m_heap_free(), m_heap_judge() and other m_heap_xxx
+ *          functions still work on it. NAME_init() flag is M_HEAP_NOINC or
+ *          M_HEAP_INC, M_EINVAL is returned for M_HEAP_SHRINK and
+ *          M_HEAP_ARITYx
+*********************************************************/
+#define M_HEAP_DEFINE(NAME, ETYPE, CMP, TYPE) \
+M_HEAP_INLINE int NAME##_compare(void *elem1, void *elem2, void *udt) \
+{ \
+    return CMP((ETYPE *)elem1, (ETYPE *)elem2); \
+} \
+\
+M_HEAP_INLINE int NAME##_init(struct m_heap *heap, int flag, size_t maxnum) \
+{ \
+    if (flag & ~M_HEAP_INC) return M_EINVAL; \
+    return m_heap_init(heap, TYPE, flag, maxnum, \
+                    NAME##_compare, NULL); \
+} \
+\
+M_HEAP_INLINE void NAME##_shift_up(struct m_heap *heap, size_t i, \
+                    ETYPE *elem) \
+{ \
+    while (i > 0) { \
+        ETYPE *parent = (ETYPE *)heap->array[(i - 1) / 2].elem; \
+        if (!M_HEAP_BEFORE(TYPE, CMP(elem, parent))) \
+            break; \
+        heap->array[i].elem = parent; \
+        i = (i - 1) / 2; \
+    } \
+    heap->array[i].elem = elem; \
+} \
+\
+M_HEAP_INLINE void NAME##_shift_down(struct m_heap *heap, size_t i, \
+                    ETYPE *elem) \
+{ \
+    size_t child = 0; \
+    ETYPE *celem = NULL; \
+    while ((child = 2 * i + 1) < heap->num) { \
+        celem = (ETYPE *)heap->array[child].elem; \
+        if (child + 1 < heap->num && M_HEAP_BEFORE(TYPE, \
+                    CMP((ETYPE *)heap->array[child + 1].elem, celem))) \
+            celem = (ETYPE *)heap->array[++child].elem; \
+        if (!M_HEAP_BEFORE(TYPE, CMP(celem, elem))) \
+            break; \
+        heap->array[i].elem = celem; \
+        i = child; \
+    } \
+    heap->array[i].elem = elem; \
+} \
+\
+M_HEAP_INLINE int NAME##_insert(struct m_heap *heap, ETYPE *elem) \
+{ \
+    if (heap->num >= heap->maxnum) { \
+        int ret = m_heap_reserve(heap, heap->num + 1); \
+        if (ret) return ret; \
+    } \
+    NAME##_shift_up(heap, heap->num++, elem); \
+    return 0; \
+} \
+\
+M_HEAP_INLINE ETYPE *NAME##_peek(struct m_heap *heap) \
+{ \
+    return heap->num ? (ETYPE *)heap->array[0].elem : NULL; \
+} \
+\
+M_HEAP_INLINE ETYPE *NAME##_pop(struct m_heap *heap) \
+{ \
+    ETYPE *elem = NULL; \
+    if (heap->num == 0) return NULL; \
+    elem = (ETYPE *)heap->array[0].elem; \
+    if (--heap->num > 0) \
+        NAME##_shift_down(heap, 0, (ETYPE *)heap->array[heap->num].elem); \
+    return elem; \
+} \
+\
+M_HEAP_INLINE int NAME##_remove(struct m_heap *heap, ETYPE *elem) \
+{ \
+    size_t i = 0; \
+    ETYPE *last = NULL; \
+    for (i = 0; i < heap->num; i++) \
+        if (CMP((ETYPE *)heap->array[i].elem, elem) == 0) \
+            break; \
+    if (i == heap->num) \
+        return M_ENOTFOUND; \
+    last = (ETYPE *)heap->array[--heap->num].elem; \
+    if (i == heap->num) \
+        return 0; \
+    if (i > 0 && M_HEAP_BEFORE(TYPE, \
+                    CMP(last, (ETYPE *)heap->array[(i - 1) / 2].elem))) \
+        NAME##_shift_up(heap, i, last); \
+    else \
+        NAME##_shift_down(heap, i, last); \
+    return 0; \
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,274 @@
+#include <string.h>
+
+#include "idxlist.h"
+
+#define IDXNODE(idx,elem) \
+    ((struct m_idxnode *)M_LIST_ELEM2NODE((elem), (idx)->list.offset))
+
+#define TOWERSIZE(level) (sizeof(struct m_idxtower) + \
+                    sizeof(struct m_idxlane) * ((level) - 1))
+
+int m_idxlist_init(struct m_idxlist *idx, size_t offset)
+{
+    return m_idxlist_init_alloc(idx, offset, NULL);
+}
+
+int m_idxlist_init_alloc(struct m_idxlist *idx, size_t offset,
+                    struct m_allocator *allocator)
+{
+    size_t i = 0;
+    if (!idx) return M_EINVAL;
+
+    idx->head = (struct m_idxtower *)M_ALLOC(allocator,
+                    TOWERSIZE(M_IDXLIST_MAXLEVEL));
+    if (!idx->head)
+        return M_EMALLOC;
+    idx->head->elem = NULL;
+    idx->head->level = M_IDXLIST_MAXLEVEL;
+    /* empty list, every lane ends one past the last element */
+    for (i = 0; i < M_IDXLIST_MAXLEVEL; i++) {
+        idx->head->lane[i].next = NULL;
+        idx->head->lane[i].span = 1;
+    }
+    m_list_init(&idx->list, offset);
+    idx->seed = 0x9e3779b9;
+    idx->allocator = allocator;
+
+    return 0;
+}
+
+int m_idxlist_free(struct m_idxlist *idx,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    struct m_idxtower *tower = NULL;
+    struct m_idxtower *next = NULL;
+    if (!idx || !idx->head) return M_EINVAL;
+
+    for (tower = idx->head->lane[0].next; tower; tower = next) {
+        next = tower->lane[0].next;
+        IDXNODE(idx, tower->elem)->tower = NULL;
+        M_FREE(idx->allocator, tower);
+    }
+    M_FREE(idx->allocator, idx->head);
+    idx->head = NULL;
+    m_list_free(&idx->list, cbk, udt);
+    idx->allocator = NULL;
+
+    return 0;
+}
+
+/* random tower level, 0 with probability 3/4, each level 1/4 of below */
+static size_t idx_level(struct m_idxlist *idx)
+{
+    size_t level = 0;
+    unsigned int r = idx->seed;
+
+    /* xorshift32 */
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    idx->seed = r;
+    while (level < M_IDXLIST_MAXLEVEL && (r & 3) == 0) {
+        level++;
+        r >>= 2;
+    }
+
+    return level;
+}
+
+/********************************************************
+ * @brief   find for every level the last tower before position 'pos'
+ * @update  receive tower of every level
+ * @rank    receive position of every 'update' tower, head is 0
+*********************************************************/
+static void idx_search(struct m_idxlist *idx, size_t pos,
+                    struct m_idxtower **update, size_t *rank)
+{
+    int i = 0;
+    size_t r = 0;
+    struct m_idxtower *x = idx->head;
+
+    for (i = M_IDXLIST_MAXLEVEL - 1; i >= 0; i--) {
+        while (x->lane[i].next && r + x->lane[i].span < pos) {
+            r += x->lane[i].span;
+            x = x->lane[i].next;
+        }
+        update[i] = x;
+        rank[i] = r;
+    }
+}
+
+/* element at position 'pos', 'x' is a tower at position 'r' <= 'pos' */
+static struct m_listnode *idx_walk(struct m_idxlist *idx,
+                    struct m_idxtower *x, size_t r, size_t pos)
+{
+    struct m_listnode *node = NULL;
+
+    if (r == 0) {
+        node = idx->list.head;
+        r = 1;
+    } else {
+        node = M_LIST_ELEM2NODE(x->elem, idx->list.offset);
+    }
+    for ( ; r < pos; r++)
+        node = node->next;
+
+    return node;
+}
+
+size_t m_idxlist_insert(struct m_idxlist *idx, void *elem, size_t pos)
+{
+    size_t i = 0;
+    size_t level = 0;
+    size_t rank[M_IDXLIST_MAXLEVEL];
+    struct m_idxtower *update[M_IDXLIST_MAXLEVEL];
+    struct m_idxtower *tower = NULL;
+    struct m_idxnode *node = NULL;
+    if (!idx || !elem) return 0;
+
+    if (pos < 1)
+        pos = 1;
+    if (pos > idx->list.length + 1)
+        pos = idx->list.length + 1;
+
+    idx_search(idx, pos, update, rank);
+    if (pos == 1)
+        m_list_prepend(&idx->list, elem);
+    else
+        m_list_insert_after(&idx->list, M_LIST_NODE2ELEM(
+                    idx_walk(idx, update[0], rank[0], pos - 1),
+                    idx->list.offset), elem);
+
+    node = IDXNODE(idx, elem);
+    node->tower = NULL;
+    level = idx_level(idx);
+    if (level) {
+        /* without memory the element just stays out of skip layer */
+        tower = (struct m_idxtower *)M_ALLOC(idx->allocator,
+                    TOWERSIZE(level));
+        if (!tower)
+            level = 0;
+    }
+    if (tower) {
+        tower->elem = elem;
+        tower->level = level;
+        node->tower = tower;
+    }
+
+    for (i = 0; i < level; i++) {
+        tower->lane[i].next = update[i]->lane[i].next;
+        tower->lane[i].span = update[i]->lane[i].span - (pos - rank[i]) + 1;
+        update[i]->lane[i].next = tower;
+        update[i]->lane[i].span = pos - rank[i];
+    }
+    for ( ; i < M_IDXLIST_MAXLEVEL; i++)
+        update[i]->lane[i].span++;
+
+    return pos;
+}
+
+int m_idxlist_append(struct m_idxlist *idx, void *elem)
+{
+    if (!idx || !elem) return M_EINVAL;
+
+    return m_idxlist_insert(idx, elem, idx->list.length + 1) ? 0 :
+                    M_EUNKNOWN;
+}
+
+size_t m_idxlist_index(struct m_idxlist *idx, void *elem)
+{
+    size_t step = 0;
+    size_t dist = 0;
+    struct m_listnode *node = NULL;
+    struct m_idxtower *x = NULL;
+    if (!idx || !elem) return 0;
+
+    /* forward to nearest element with a tower, mostly a few steps */
+    node = M_LIST_ELEM2NODE(elem, idx->list.offset);
+    while (node && !((struct m_idxnode *)node)->tower) {
+        node = node->next;
+        step++;
+    }
+    if (!node)
+        return idx->list.length + 1 - step;
+
+    /* ride top lanes to the end, levels only grow on the way */
+    x = ((struct m_idxnode *)node)->tower;
+    for (;;) {
+        dist += x->lane[x->level - 1].span;
+        if (!x->lane[x->level - 1].next)
+            break;
+        x = x->lane[x->level - 1].next;
+    }
+
+    return idx->list.length + 1 - dist - step;
+}
+
+void *m_idxlist_nth(struct m_idxlist *idx, size_t n)
+{
+    size_t rank[M_IDXLIST_MAXLEVEL];
+    struct m_idxtower *update[M_IDXLIST_MAXLEVEL];
+    if (!idx) return NULL;
+    if (n < 1 || n > idx->list.length) return NULL;
+
+    /* last tower before n + 1 is at n or before it */
+    idx_search(idx, n + 1, update, rank);
+    return M_LIST_NODE2ELEM(idx_walk(idx, update[0], rank[0], n),
+                    idx->list.offset);
+}
+
+/* unlink element at position 'pos' */
+static void idx_unlink(struct m_idxlist *idx, void *elem, size_t pos)
+{
+    size_t i = 0;
+    size_t rank[M_IDXLIST_MAXLEVEL];
+    struct m_idxtower *update[M_IDXLIST_MAXLEVEL];
+    struct m_idxnode *node = IDXNODE(idx, elem);
+    struct m_idxtower *tower = node->tower;
+
+    idx_search(idx, pos, update, rank);
+    for (i = 0; i < M_IDXLIST_MAXLEVEL; i++) {
+        if (tower && i < tower->level) {
+            update[i]->lane[i].span += tower->lane[i].span - 1;
+            update[i]->lane[i].next = tower->lane[i].next;
+        } else {
+            update[i]->lane[i].span--;
+        }
+    }
+    if (tower) {
+        M_FREE(idx->allocator, tower);
+        node->tower = NULL;
+    }
+    m_list_remove(&idx->list, elem);
+}
+
+int m_idxlist_remove(struct m_idxlist *idx, void *elem)
+{
+    size_t pos = 0;
+    if (!idx || !elem) return M_EINVAL;
+
+    pos = m_idxlist_index(idx, elem);
+    if (pos < 1 || pos > idx->list.length)
+        return M_ENOTFOUND;
+    idx_unlink(idx, elem, pos);
+
+    return 0;
+}
+
+void *m_idxlist_pop(struct m_idxlist *idx, size_t n)
+{
+    void *elem = NULL;
+
+    elem = m_idxlist_nth(idx, n);
+    if (elem)
+        idx_unlink(idx, elem, n);
+
+    return elem;
+}
+
+size_t m_idxlist_length(struct m_idxlist *idx)
+{
+    if (!idx) return 0;
+
+    return idx->list.length;
+}
@@ -0,0 +1,172 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    indexable list, m_list with a skip layer for positional access
+*****************************************************/
+
+#ifndef __MINIDS_IDXLIST_H__
+#define __MINIDS_IDXLIST_H__
+
+#include <stdlib.h>
+
+#include "list.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_IDXLIST_MAXLEVEL  16 /* skip levels above the list, 4^16 elements */
+
+struct m_idxtower;
+
+/********************************************************
+ * @brief   express lane of a tower at one level
+ * @next    next tower at this level, NULL if none
+ * @span    numbers of list step to 'next', or to one past the last
+ *          element if 'next' is NULL
+*********************************************************/
+struct m_idxlane {
+    struct m_idxtower *next;
+    size_t span;
+};
+
+/* tower of one element in skip layer, 'level' lanes allocated */
+struct m_idxtower {
+    void *elem;
+    size_t level;
+    struct m_idxlane lane[1];
+};
+
+/********************************************************
+ * @brief   node embedded in element, it starts with m_listnode so the
+ *          element is a plain m_list member as well
+ * @node    list node, linked by 'list' of m_idxlist
+ * @tower   skip tower of element, NULL for most elements
+*********************************************************/
+struct m_idxnode {
+    struct m_listnode node;
+    struct m_idxtower *tower;
+};
+
+/********************************************************
+ * @brief   indexable list struct define
+ *          'list' is a normal m_list of all element, so m_list_next(),
+ *          m_list_prev(), m_list_first() and the like work on it in
+ *          O(1), one element in 4 (1 in 16 at level 2 ...) also get a
+ *          tower in the skip layer, every lane counts the list steps it
+ *          jumps, so position lookup, insert and remove are O(log n)
+ *          NOTE! change elements only by m_idxlist_*(), never by
+ *          m_list_*() on 'list'
+ * @list    list of all element
+ * @head    head tower, it stands before first element
+ * @seed    random state of tower level
+ * @allocator memory allocator of towers, NULL for libc
+*********************************************************/
+struct m_idxlist {
+    struct m_list list;
+    struct m_idxtower *head;
+    unsigned int seed;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize list instance
+ * @idx     list instance addr
+ * @offset  m_idxnode offset in element, M_LIST_OFFSET(type, idxnode)
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_idxlist_init(struct m_idxlist *idx, size_t offset);
+
+/********************************************************
+ * @brief   initialize list instance with a memory allocator of towers
+ * @idx     list instance addr
+ * @offset  m_idxnode offset in element
+ * @allocator allocator of tower memory, NULL for libc, must outlive list
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_idxlist_init_alloc(struct m_idxlist *idx, size_t offset,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset list instance and release skip layer
+ * @idx     list instance addr
+ * @cbk     callback of every element in order, may be NULL
+ * @udt     opaque param pass to callback
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_idxlist_free(struct m_idxlist *idx,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   insert a new element at the give position, O(log n)
+ * @idx     list instance addr
+ * @elem    the new element
+ * @pos     position, head pos is 1, if pos<1 will insert into start of
+ *          list, if pos larger than list length will insert into end
+ * @return  real inserted position, 0 otherwise
+********************************************************/
+size_t m_idxlist_insert(struct m_idxlist *idx, void *elem, size_t pos);
+
+/*******************************************************
+ * @brief   append a new element to the end of list, O(log n)
+ * @idx     list instance addr
+ * @elem    the new element
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_idxlist_append(struct m_idxlist *idx, void *elem);
+
+/*******************************************************
+ * @brief   remove an element from list, O(log n)
+ * @idx     list instance addr
+ * @elem    the element, must in list
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_idxlist_remove(struct m_idxlist *idx, void *elem);
+
+/*******************************************************
+ * @brief   popup n-th element, O(log n)
+ * @idx     list instance addr
+ * @n       n-th, first element is 1, if out of range will return NULL
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_idxlist_pop(struct m_idxlist *idx, size_t n);
+
+/*******************************************************
+ * @brief   get n-th element, O(log n)
+ * @idx     list instance addr
+ * @n       n-th, first element is 1, if out of range will return NULL
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_idxlist_nth(struct m_idxlist *idx, size_t n);
+
+/*******************************************************
+ * @brief   get index of give element, O(log n)
+ * @idx     list instance addr
+ * @elem    the element, must in list
+ * @return  index, first element is 1, 0 on error
+********************************************************/
+size_t m_idxlist_index(struct m_idxlist *idx, void *elem);
+
+/*******************************************************
+ * @brief   get list length
+ * @idx     list instance addr
+ * @return  list length
+********************************************************/
+size_t m_idxlist_length(struct m_idxlist *idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -353,99 +353,169 @@ void *m_list_find(struct m_list *list, void *key,
     return NULL;
 }
 
-#if 0
-static struct sl_listnode *list_sort_merge(struct sl_list *list,
-                    struct sl_listnode *n1,
-                    struct sl_listnode *n2,
-                    int (*compare)(void *a, void *b, void *udt),
-                    void *udt)
+/* merge two sorted NULL terminated chains, 'a' wins ties, prev is not set */
+static struct m_listnode *list_merge_chain(struct m_list *list,
+                    struct m_listnode *a, struct m_listnode *b,
+                    int (*compare)(void *a, void *b, void *udt), void *udt)
 {
-    struct sl_listnode head, *node, *prev;
-    int cmp;
-
-    node = &head;
-    prev = NULL;
-    while (n1 && n2) {
-        cmp=compare(SL_LIST_NODE2DATA(n1,list->offset), 
-                            SL_LIST_NODE2DATA(n2, list->offset), udt);
-        
-        if (cmp <= 0) {
-            node->next = n1;
-            n1 = n1->next;
+    struct m_listnode head;
+    struct m_listnode *tail = &head;
+
+    while (a && b) {
+        if (compare(M_LIST_NODE2ELEM(a, list->offset),
+                    M_LIST_NODE2ELEM(b, list->offset), udt) <= 0) {
+            tail->next = a;
+            a = a->next;
         } else {
-            node->next = n2;
-            n2 = n2->next;
+            tail->next = b;
+            b = b->next;
         }
-        node = node->next;
-        node->prev = prev;
-        prev = node;
+        tail = tail->next;
     }
-    node->next = n1 ? n1 : n2;
-    node->next->prev = node;
+    tail->next = a ? a : b;
 
     return head.next;
 }
 
-static struct sl_listnode *list_sort_split(struct sl_list *list,
-                    struct sl_listnode *node,
-                    int (*compare)(void *a, void *b, void *udt),
-                    void *udt)
+/* rebuild prev links and tail after a chain was relinked by next only */
+static void list_relink(struct m_list *list, struct m_listnode *head)
 {
-    struct sl_listnode *n1, *n2;
+    struct m_listnode *prev = NULL;
+    struct m_listnode *node = NULL;
 
-    if (!node)
-        return NULL;
-    if (!node->next)
-        return node;
-
-    n1 = node;
-    n2 = node->next;
-    while ((n2 = n2->next) != NULL) {
-        if ((n2 = n2->next) == NULL)
-            break;
-        n1 = n1->next;
+    for (node = head; node; node = node->next) {
+        node->prev = prev;
+        prev = node;
     }
-    n2 = n1->next;
-    n1->next = NULL;
-
-    return list_sort_merge(list, list_sort_split(list, node, compare, udt),
-                        list_sort_split(list, n2, compare, udt), compare, udt);
+    list->head = head;
+    list->tail = prev;
 }
 
-int sl_list_sort(struct sl_list *list,
+#define LIST_MINRUN 8 /* short runs are grown by insertion to this length */
+
+/********************************************************
+ * @brief   cut the natural run starting at 'node' off the chain, a
+ *          strictly descending run is reversed, so it is still stable,
+ *          a run shorter than LIST_MINRUN is grown by stable insertion
+ * @next    receive first node after the run
+ * @return  first node of the run
+*********************************************************/
+static struct m_listnode *list_take_run(struct m_list *list,
+                    struct m_listnode *node, struct m_listnode **next,
                     int (*compare)(void *a, void *b, void *udt), void *udt)
 {
-    struct sl_listnode *node = NULL;
-    if (!list || !compare) return LIST_EINVAL;
+    struct m_listnode *run = node;
+    struct m_listnode *last = node;
+    struct m_listnode *tmp = NULL;
+    struct m_listnode **pos = NULL;
+    size_t len = 1;
+
+    node = node->next;
+    if (node && compare(M_LIST_NODE2ELEM(last, list->offset),
+                    M_LIST_NODE2ELEM(node, list->offset), udt) > 0) {
+        /* descending, push every node to the front */
+        run->next = NULL;
+        while (node && compare(M_LIST_NODE2ELEM(run, list->offset),
+                    M_LIST_NODE2ELEM(node, list->offset), udt) > 0) {
+            tmp = node->next;
+            node->next = run;
+            run = node;
+            node = tmp;
+            len++;
+        }
+    } else {
+        while (node && compare(M_LIST_NODE2ELEM(last, list->offset),
+                    M_LIST_NODE2ELEM(node, list->offset), udt) <= 0) {
+            last = node;
+            node = node->next;
+            len++;
+        }
+        last->next = NULL;
+    }
 
-    list->head = list_sort_split(list, list->head, compare, udt);
-    if (list->head) {
-        for (node = list->head; node->next; node = node->next);
-        list->tail = node;
+    /* random input has runs of 2, merging those level by level is slow */
+    for ( ; node && len < LIST_MINRUN; len++) {
+        tmp = node->next;
+        for (pos = &run; *pos; pos = &(*pos)->next)
+            if (compare(M_LIST_NODE2ELEM(*pos, list->offset),
+                    M_LIST_NODE2ELEM(node, list->offset), udt) > 0)
+                break;
+        node->next = *pos;
+        *pos = node;
+        node = tmp;
     }
+    *next = node;
 
-    return 0;
+    return run;
 }
 
-
-int sl_list_insert_sorted(struct sl_list *list, void *data,
+int m_list_sort(struct m_list *list,
                     int (*compare)(void *a, void *b, void *udt), void *udt)
 {
-    struct sl_listnode *node = NULL;
-    if (!list || !compare) return LIST_EINVAL;
+    size_t i = 0;
+    size_t top = 0;
+    struct m_listnode *run = NULL;
+    struct m_listnode *node = NULL;
+    /* pending[i] holds 2^i runs merged, 2^64 runs is plenty */
+    struct m_listnode *pending[64];
+    if (!list || !compare) return M_EINVAL;
+
+    if (list->length < 2)
+        return 0;
 
+    /* binary counter over natural runs, earlier runs sit in higher slots */
     node = list->head;
     while (node) {
-        if (compare(SL_LIST_NODE2DATA(node,list->offset), data, udt) < 0) {
-            sl_list_insert_before(list,data,SL_LIST_NODE2DATA(node,list->offset));
-            break;
+        run = list_take_run(list, node, &node, compare, udt);
+        for (i = 0; i < top && pending[i]; i++) {
+            run = list_merge_chain(list, pending[i], run, compare, udt);
+            pending[i] = NULL;
         }
-        node = node->next;
+        if (i == top)
+            top++;
+        pending[i] = run;
     }
 
-    if (!node)
-        sl_list_append(list, data);
+    run = NULL;
+    for (i = 0; i < top; i++)
+        if (pending[i])
+            run = run ? list_merge_chain(list, pending[i], run, compare, udt)
+                      : pending[i];
+    list_relink(list, run);
+
+    return 0;
+}
+
+int m_list_merge(struct m_list *list, struct m_list *other,
+                    int (*compare)(void *a, void *b, void *udt), void *udt)
+{
+    if (!list || !other || !compare) return M_EINVAL;
+    if (list == other || list->offset != other->offset) return M_EINVAL;
+
+    if (list->tail)
+        list->tail->next = NULL;
+    if (other->tail)
+        other->tail->next = NULL;
+    list_relink(list, list_merge_chain(list, list->head, other->head,
+                    compare, udt));
+    list->length += other->length;
+    other->head = other->tail = NULL;
+    other->length = 0;
 
     return 0;
 }
-#endif
+
+int m_list_insert_sorted(struct m_list *list, void *elem,
+                    int (*compare)(void *a, void *b, void *udt), void *udt)
+{
+    struct m_listnode *node = NULL;
+    if (!list || !elem || !compare) return M_EINVAL;
+
+    /* walk back from tail, appending sorted input is O(1) */
+    for (node = list->tail; node; node = node->prev)
+        if (compare(M_LIST_NODE2ELEM(node, list->offset), elem, udt) <= 0)
+            return m_list_insert_after(list,
+                    M_LIST_NODE2ELEM(node, list->offset), elem);
+
+    return m_list_prepend(list, elem);
+}
@@ -17,6 +17,10 @@ extern "C" {
 #define M_EINVAL    (-1) /* invalid arguments */
 #define M_EUNKNOWN  (-2) /* unknown error */
 #define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
 #endif
 
 /*******************************************************
@@ -276,13 +280,50 @@ int m_list_dup(struct m_list *list, struct m_list *duplist,
 void *m_list_find(struct m_list *list, void *key,
                 int (*cbk)(void *elem, void *key, void *udt), void *udt);
 
-/*
-int sl_list_sort(struct sl_list *list,
+/*******************************************************
+ * @brief   sort whole list, stable, O(n log n) and no extra memory
+ *          bottom-up merge of natural runs, so a nearly sorted list (or a
+ *          reversed one) is sorted in about linear time
+ * @list    list instance addr
+ * @compare compare callback, return <0, 0, >0 if a is less, equal or
+ *          greater than b
+ * @udt     opaque pram pass to callback
+ * @sample  int cbk_cmp(void *a, void *b, void *udt)
+ *          {
+ *              return ((struct element *)a)->key -
+ *                     ((struct element *)b)->key;
+ *          }
+ *          m_list_sort(list, cbk_cmp, NULL);
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_list_sort(struct m_list *list,
+                    int (*compare)(void *a, void *b, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   merge sorted list 'other' into sorted list 'list', stable,
+ *          elements of 'list' go first on equal keys, 'other' is empty
+ *          after merge
+ * @list    list instance addr
+ * @other   another list of same node offset
+ * @compare compare callback, see m_list_sort()
+ * @udt     opaque pram pass to callback
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_list_merge(struct m_list *list, struct m_list *other,
                     int (*compare)(void *a, void *b, void *udt), void *udt);
-                    
-int sl_list_insert_sorted(struct sl_list *list, void *data,
+
+/*******************************************************
+ * @brief   insert a new element into sorted list, after all equal ones
+ *          search from tail, so sorted appends cost O(1)
+ * @list    list instance addr
+ * @elem    the new element
+ * @compare compare callback, see m_list_sort()
+ * @udt     opaque pram pass to callback
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_list_insert_sorted(struct m_list *list, void *elem,
                     int (*compare)(void *a, void *b, void *udt), void *udt);
-*/
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "listhash.h"
+#include "pow2.h"
+
+#define HASHNODE(lh,elem) \
+    ((struct m_hashnode *)((size_t)(elem) + (lh)->hoffset))
+#define HASH2ELEM(lh,node) ((void *)((size_t)(node) - (lh)->hoffset))
+
+int m_listhash_init(struct m_listhash *lh, size_t offset, size_t hoffset,
+                    size_t nbucket, size_t (*hash)(void *key, void *udt),
+                    int (*cmp)(void *elem, void *key, void *udt), void *udt)
+{
+    return m_listhash_init_alloc(lh, offset, hoffset, nbucket, hash, cmp,
+                    udt, NULL);
+}
+
+int m_listhash_init_alloc(struct m_listhash *lh, size_t offset,
+                    size_t hoffset, size_t nbucket,
+                    size_t (*hash)(void *key, void *udt),
+                    int (*cmp)(void *elem, void *key, void *udt), void *udt,
+                    struct m_allocator *allocator)
+{
+    size_t cap = 0;
+    if (!lh || !hash || !cmp) return M_EINVAL;
+
+    cap = m_pow2_roundup(nbucket, 1);
+    if (!cap || cap > (size_t)-1 / sizeof(struct m_hashnode *))
+        return M_EINVAL;
+    lh->buckets = (struct m_hashnode **)M_ALLOC(allocator,
+                    sizeof(struct m_hashnode *) * cap);
+    if (!lh->buckets)
+        return M_EMALLOC;
+    memset(lh->buckets, 0, sizeof(struct m_hashnode *) * cap);
+    m_list_init(&lh->list, offset);
+    lh->mask = cap - 1;
+    lh->hoffset = hoffset;
+    lh->hash = hash;
+    lh->cmp = cmp;
+    lh->udt = udt;
+    lh->allocator = allocator;
+
+    return 0;
+}
+
+int m_listhash_free(struct m_listhash *lh,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    if (!lh || !lh->buckets) return M_EINVAL;
+
+    m_list_free(&lh->list, cbk, udt);
+    M_FREE(lh->allocator, lh->buckets);
+    lh->buckets = NULL;
+    lh->mask = 0;
+    lh->allocator = NULL;
+
+    return 0;
+}
+
+/* double bucket array, chains are split by the stored hash */
+static void listhash_grow(struct m_listhash *lh)
+{
+    size_t i = 0;
+    size_t cap = (lh->mask + 1) * 2;
+    struct m_hashnode *node = NULL;
+    struct m_hashnode *next = NULL;
+    struct m_hashnode **buckets = NULL;
+
+    /* without memory chains just get longer */
+    buckets = (struct m_hashnode **)M_ALLOC(lh->allocator,
+                    sizeof(struct m_hashnode *) * cap);
+    if (!buckets)
+        return;
+    memset(buckets, 0, sizeof(struct m_hashnode *) * cap);
+    for (i = 0; i <= lh->mask; i++) {
+        for (node = lh->buckets[i]; node; node = next) {
+            next = node->next;
+            node->next = buckets[node->hash & (cap - 1)];
+            buckets[node->hash & (cap - 1)] = node;
+        }
+    }
+    M_FREE(lh->allocator, lh->buckets);
+    lh->buckets = buckets;
+    lh->mask = cap - 1;
+}
+
+/* slot that points to node of 'key', or to the NULL end of its chain */
+static struct m_hashnode **listhash_slot(struct m_listhash *lh, void *key,
+                    size_t hash)
+{
+    struct m_hashnode **slot = &lh->buckets[hash & lh->mask];
+
+    for ( ; *slot; slot = &(*slot)->next)
+        if ((*slot)->hash == hash &&
+            lh->cmp(HASH2ELEM(lh, *slot), key, lh->udt) == 0)
+            break;
+
+    return slot;
+}
+
+int m_listhash_insert(struct m_listhash *lh, void *elem, void *key)
+{
+    size_t hash = 0;
+    struct m_hashnode *node = NULL;
+    struct m_hashnode **slot = NULL;
+    if (!lh || !elem) return M_EINVAL;
+
+    hash = lh->hash(key, lh->udt);
+    slot = listhash_slot(lh, key, hash);
+    if (*slot)
+        return M_EEXISTS;
+
+    node = HASHNODE(lh, elem);
+    node->hash = hash;
+    node->next = NULL;
+    *slot = node;
+    m_list_append(&lh->list, elem);
+    if (lh->list.length > lh->mask + 1)
+        listhash_grow(lh);
+
+    return 0;
+}
+
+void *m_listhash_find(struct m_listhash *lh, void *key)
+{
+    struct m_hashnode **slot = NULL;
+    if (!lh) return NULL;
+
+    slot = listhash_slot(lh, key, lh->hash(key, lh->udt));
+    return *slot ? HASH2ELEM(lh, *slot) : NULL;
+}
+
+int m_listhash_remove(struct m_listhash *lh, void *elem)
+{
+    struct m_hashnode *node = NULL;
+    struct m_hashnode **slot = NULL;
+    if (!lh || !elem) return M_EINVAL;
+
+    node = HASHNODE(lh, elem);
+    for (slot = &lh->buckets[node->hash & lh->mask]; *slot;
+                    slot = &(*slot)->next)
+        if (*slot == node)
+            break;
+    if (!*slot)
+        return M_ENOTFOUND;
+
+    *slot = node->next;
+    node->next = NULL;
+    m_list_remove(&lh->list, elem);
+
+    return 0;
+}
+
+void *m_listhash_remove_key(struct m_listhash *lh, void *key)
+{
+    void *elem = NULL;
+    struct m_hashnode *node = NULL;
+    struct m_hashnode **slot = NULL;
+    if (!lh) return NULL;
+
+    slot = listhash_slot(lh, key, lh->hash(key, lh->udt));
+    if (!*slot)
+        return NULL;
+
+    node = *slot;
+    *slot = node->next;
+    node->next = NULL;
+    elem = HASH2ELEM(lh, node);
+    m_list_remove(&lh->list, elem);
+
+    return elem;
+}
+
+size_t m_listhash_length(struct m_listhash *lh)
+{
+    return lh ? lh->list.length : 0;
+}
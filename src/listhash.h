@@ -0,0 +1,154 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    insertion ordered hash, m_list with a hash index by key
+*****************************************************/
+
+#ifndef __MINIDS_LISTHASH_H__
+#define __MINIDS_LISTHASH_H__
+
+#include <stdlib.h>
+
+#include "list.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/* hash link embedded in element next to its m_listnode */
+struct m_hashnode {
+    struct m_hashnode *next;
+    size_t hash;
+};
+
+/********************************************************
+ * @brief   list hash struct define
+ *          'list' is a normal m_list of all element in insert order, so
+ *          m_list_first(), m_list_next(), m_list_travarsal() and the like
+ *          work on it, every element is also chained in a bucket by hash
+ *          of its key, so find and remove by key are O(1), the bucket
+ *          array doubles when length exceeds it
+ *          NOTE! add and remove elements only by m_listhash_*()
+ * @list    list of all element in insert order
+ * @buckets bucket array of 'mask' + 1 chains
+ * @mask    bucket numbers - 1, power of 2
+ * @hoffset m_hashnode offset in element
+ * @hash    callback of key hash
+ * @cmp     callback of compare element with key, 0 if equal
+ * @udt     opaque param pass to callbacks
+ * @allocator memory allocator of buckets, NULL for libc
+*********************************************************/
+struct m_listhash {
+    struct m_list list;
+    struct m_hashnode **buckets;
+    size_t mask;
+    size_t hoffset;
+    size_t (*hash)(void *key, void *udt);
+    int (*cmp)(void *elem, void *key, void *udt);
+    void *udt;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize list hash instance
+ * @lh      list hash instance addr
+ * @offset  m_listnode offset in element, M_LIST_OFFSET(type, listnode)
+ * @hoffset m_hashnode offset in element, M_LIST_OFFSET(type, hashnode)
+ * @nbucket initial bucket numbers, rounded up to power of 2
+ * @hash    return hash of key
+ * @cmp     return 0 if key of element equal to key, same as the callback
+ *          of m_list_find()
+ * @udt     opaque param pass to 'hash' and 'cmp'
+ * @sample  struct element {
+ *              int key;
+ *              struct m_listnode listnode;
+ *              struct m_hashnode hashnode;
+ *          };
+ *          m_listhash_init(lh, M_LIST_OFFSET(struct element, listnode),
+ *                  M_LIST_OFFSET(struct element, hashnode), 64,
+ *                  cbk_hash, cbk_cmp, NULL);
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_listhash_init(struct m_listhash *lh, size_t offset, size_t hoffset,
+                    size_t nbucket, size_t (*hash)(void *key, void *udt),
+                    int (*cmp)(void *elem, void *key, void *udt), void *udt);
+
+/********************************************************
+ * @brief   initialize list hash instance with a memory allocator, see
+ *          m_listhash_init()
+ * @allocator allocator of bucket memory, NULL for libc, must outlive it
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_listhash_init_alloc(struct m_listhash *lh, size_t offset,
+                    size_t hoffset, size_t nbucket,
+                    size_t (*hash)(void *key, void *udt),
+                    int (*cmp)(void *elem, void *key, void *udt), void *udt,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset list hash instance and release buckets
+ * @lh      list hash instance addr
+ * @cbk     callback of every element in insert order, may be NULL
+ * @udt     opaque param pass to callback
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_listhash_free(struct m_listhash *lh,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   append a new element to the end of list and index it by key
+ * @lh      list hash instance addr
+ * @elem    the new element
+ * @key     key of element
+ * @return  0 success, M_EEXISTS if an element of equal key is in list,
+ *          M_EXXX otherwise
+********************************************************/
+int m_listhash_insert(struct m_listhash *lh, void *elem, void *key);
+
+/*******************************************************
+ * @brief   find an element by key, O(1)
+ * @lh      list hash instance addr
+ * @key     the key
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_listhash_find(struct m_listhash *lh, void *key);
+
+/*******************************************************
+ * @brief   remove an element from list and index, O(1)
+ * @lh      list hash instance addr
+ * @elem    the element, must in list
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_listhash_remove(struct m_listhash *lh, void *elem);
+
+/*******************************************************
+ * @brief   remove the element of given key, O(1)
+ * @lh      list hash instance addr
+ * @key     the key
+ * @return  removed element addr, NULL if not found
+********************************************************/
+void *m_listhash_remove_key(struct m_listhash *lh, void *key);
+
+/*******************************************************
+ * @brief   get numbers of element
+ * @lh      list hash instance addr
+ * @return  list length
+********************************************************/
+size_t m_listhash_length(struct m_listhash *lh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+#define _GNU_SOURCE
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "magicring.h"
+#include "pow2.h"
+
+int m_magicring_init(struct m_magicring *ring, size_t size)
+{
+    int fd = -1;
+    size_t cap = 0;
+    char *base = NULL;
+    if (!ring || size <= 0) return M_EINVAL;
+
+    /* 2 * cap of address space is reserved below */
+    if (size > M_POW2_MAX / 2)
+        return M_EINVAL;
+    cap = m_pow2_roundup(size, (size_t)sysconf(_SC_PAGESIZE));
+
+    fd = memfd_create("m_magicring", MFD_CLOEXEC);
+    if (fd < 0)
+        return M_EMALLOC;
+    if (ftruncate(fd, cap) < 0) {
+        close(fd);
+        return M_EMALLOC;
+    }
+
+    /* reserve 2 * cap of address space, then map the file over each half */
+    base = (char *)mmap(NULL, 2 * cap, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return M_EMALLOC;
+    }
+    if (mmap(base, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                    fd, 0) == MAP_FAILED ||
+        mmap(base + cap, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                    fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * cap);
+        close(fd);
+        return M_EMALLOC;
+    }
+    /* mappings keep the pages alive */
+    close(fd);
+
+    ring->base = base;
+    ring->cap = cap;
+    ring->tail = ring->headcache = 0;
+    ring->head = ring->tailcache = 0;
+
+    return 0;
+}
+
+void m_magicring_free(struct m_magicring *ring)
+{
+    if (!ring || !ring->base) return;
+
+    munmap(ring->base, 2 * ring->cap);
+    ring->base = NULL;
+    ring->cap = 0;
+    ring->tail = ring->headcache = 0;
+    ring->head = ring->tailcache = 0;
+}
+
+void *m_magicring_reserve(struct m_magicring *ring, size_t n, size_t *room)
+{
+    size_t tail = 0;
+    if (!ring || !room) return NULL;
+
+    tail = ring->tail;
+    *room = ring->cap - (tail - ring->headcache);
+    if (*room < n) {
+        ring->headcache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        *room = ring->cap - (tail - ring->headcache);
+    }
+
+    return *room >= n ? ring->base + (tail & (ring->cap - 1)) : NULL;
+}
+
+void m_magicring_commit(struct m_magicring *ring, size_t n)
+{
+    if (!ring) return;
+
+    __atomic_store_n(&ring->tail, ring->tail + n, __ATOMIC_RELEASE);
+}
+
+void *m_magicring_peek(struct m_magicring *ring, size_t n, size_t *avail)
+{
+    size_t head = 0;
+    if (!ring || !avail) return NULL;
+
+    head = ring->head;
+    *avail = ring->tailcache - head;
+    if (*avail < n) {
+        ring->tailcache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        *avail = ring->tailcache - head;
+    }
+
+    return *avail >= n ? ring->base + (head & (ring->cap - 1)) : NULL;
+}
+
+void m_magicring_release(struct m_magicring *ring, size_t n)
+{
+    if (!ring) return;
+
+    __atomic_store_n(&ring->head, ring->head + n, __ATOMIC_RELEASE);
+}
+
+size_t m_magicring_num(struct m_magicring *ring)
+{
+    size_t head = 0;
+    if (!ring) return 0;
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - head;
+}
@@ -0,0 +1,110 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    double mapped byte ring, wraparound access is contiguous
+*****************************************************/
+
+#ifndef __MINIDS_MAGICRING_H__
+#define __MINIDS_MAGICRING_H__
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/********************************************************
+ * @brief   magic ring struct define
+ *          the same memfd pages are mapped twice back to back, byte
+ *          'cap' + i is byte i, so any span of up to 'cap' bytes from
+ *          any offset is contiguous memory, producer writes and consumer
+ *          parses in place without splitting at the end of the ring
+ *          one producer thread and one consumer thread may run without
+ *          lock, same scheme as m_recqueue
+ * @base    start of the 2 * 'cap' bytes mapping
+ * @cap     capacity in bytes, power of 2 multiple of page size
+ * @tail    next byte to write, written by producer only
+ * @headcache producer's copy of head
+ * @head    next byte to read, written by consumer only
+ * @tailcache consumer's copy of tail
+*********************************************************/
+struct m_magicring {
+    char *base;
+    size_t cap;
+    char pad0[64];
+    size_t tail;
+    size_t headcache;
+    char pad1[64];
+    size_t head;
+    size_t tailcache;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   initialize ring
+ * @ring    ring instance addr
+ * @size    min capacity in bytes, rounded up to power of 2 pages
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_magicring_init(struct m_magicring *ring, size_t size);
+
+/*******************************************************
+ * @brief   unmap ring memory, producer and consumer must be stopped
+ * @ring    ring instance addr
+********************************************************/
+void m_magicring_free(struct m_magicring *ring);
+
+/*******************************************************
+ * @brief   get contiguous free space to write, producer only
+ * @ring    ring instance addr
+ * @n       min bytes wanted, up to 'cap'
+ * @room    free bytes at returned addr, may be more than 'n'
+ * @return  first free byte, NULL if less than 'n' bytes are free
+********************************************************/
+void *m_magicring_reserve(struct m_magicring *ring, size_t n, size_t *room);
+
+/*******************************************************
+ * @brief   publish first 'n' reserved bytes to consumer, producer only
+ * @ring    ring instance addr
+ * @n       bytes written, not more than granted
+********************************************************/
+void m_magicring_commit(struct m_magicring *ring, size_t n);
+
+/*******************************************************
+ * @brief   get contiguous committed bytes to read, consumer only
+ * @ring    ring instance addr
+ * @n       min bytes wanted, such as a whole record, up to 'cap'
+ * @avail   readable bytes at returned addr, may be more than 'n'
+ * @return  first readable byte, NULL if less than 'n' bytes are readable
+********************************************************/
+void *m_magicring_peek(struct m_magicring *ring, size_t n, size_t *avail);
+
+/*******************************************************
+ * @brief   give first 'n' peeked bytes back to producer, consumer only
+ * @ring    ring instance addr
+ * @n       bytes consumed, not more than granted
+********************************************************/
+void m_magicring_release(struct m_magicring *ring, size_t n);
+
+/********************************************************
+ * @brief   get committed bytes in ring
+ * @ring    ring instance addr
+ * @return  numbers of byte
+*********************************************************/
+size_t m_magicring_num(struct m_magicring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+
+#include <stddef.h>
+#include <sched.h>
+
+#include "mpmcqueue.h"
+#include "pow2.h"
+
+int m_mpmcqueue_init(struct m_mpmcqueue *que, size_t maxnum)
+{
+    return m_mpmcqueue_init_alloc(que, maxnum, NULL);
+}
+
+int m_mpmcqueue_init_alloc(struct m_mpmcqueue *que, size_t maxnum,
+                    struct m_allocator *allocator)
+{
+    size_t i = 0;
+    size_t cap = 0;
+    if (!que || maxnum <= 0) return M_EINVAL;
+
+    cap = m_pow2_roundup(maxnum, 2);
+    if (!cap || cap > (size_t)-1 / sizeof(struct m_mpmcslot))
+        return M_EINVAL;
+    que->array = (struct m_mpmcslot *)M_ALLOC(allocator,
+                    sizeof(struct m_mpmcslot) * cap);
+    if (!que->array)
+        return M_EMALLOC;
+    for (i = 0; i < cap; i++)
+        que->array[i].seq = i;
+    que->mask = cap - 1;
+    que->allocator = allocator;
+    que->tail = 0;
+    que->head = 0;
+
+    return 0;
+}
+
+void m_mpmcqueue_free(struct m_mpmcqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    void *elem = NULL;
+    if (!que || !que->array) return;
+
+    while ((elem = m_mpmcqueue_try_deque(que)) != NULL)
+        if (cbk) cbk(elem, udt);
+    M_FREE(que->allocator, que->array);
+    que->array = NULL;
+    que->allocator = NULL;
+    que->mask = 0;
+    que->tail = 0;
+    que->head = 0;
+}
+
+int m_mpmcqueue_try_enque(struct m_mpmcqueue *que, void *elem)
+{
+    size_t seq = 0;
+    size_t pos = 0;
+    ptrdiff_t dif = 0;
+    struct m_mpmcslot *slot = NULL;
+    if (!que || !elem) return M_EINVAL;
+
+    pos = __atomic_load_n(&que->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &que->array[pos & que->mask];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        dif = (ptrdiff_t)(seq - pos);
+        if (dif == 0) {
+            /* slot is free, claim position, 'pos' is reloaded if lost */
+            if (__atomic_compare_exchange_n(&que->tail, &pos, pos + 1, 1,
+                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (dif < 0) {
+            /* slot still hold element of last lap */
+            return M_ETOOMANY;
+        } else {
+            pos = __atomic_load_n(&que->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->elem = elem;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void *m_mpmcqueue_try_deque(struct m_mpmcqueue *que)
+{
+    size_t seq = 0;
+    size_t pos = 0;
+    ptrdiff_t dif = 0;
+    void *elem = NULL;
+    struct m_mpmcslot *slot = NULL;
+    if (!que) return NULL;
+
+    pos = __atomic_load_n(&que->head, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &que->array[pos & que->mask];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        dif = (ptrdiff_t)(seq - (pos + 1));
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&que->head, &pos, pos + 1, 1,
+                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (dif < 0) {
+            /* slot not filled yet */
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&que->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    elem = slot->elem;
+    /* free slot for producer of next lap */
+    __atomic_store_n(&slot->seq, pos + que->mask + 1, __ATOMIC_RELEASE);
+
+    return elem;
+}
+
+int m_mpmcqueue_enque(struct m_mpmcqueue *que, void *elem)
+{
+    int ret = 0;
+    int spin = 0;
+
+    while ((ret = m_mpmcqueue_try_enque(que, elem)) == M_ETOOMANY) {
+        if (++spin >= M_MPMC_SPIN) {
+            spin = 0;
+            sched_yield();
+        }
+    }
+
+    return ret;
+}
+
+void *m_mpmcqueue_deque(struct m_mpmcqueue *que)
+{
+    int spin = 0;
+    void *elem = NULL;
+    if (!que) return NULL;
+
+    while ((elem = m_mpmcqueue_try_deque(que)) == NULL) {
+        if (++spin >= M_MPMC_SPIN) {
+            spin = 0;
+            sched_yield();
+        }
+    }
+
+    return elem;
+}
+
+size_t m_mpmcqueue_num(struct m_mpmcqueue *que)
+{
+    size_t head = 0;
+    size_t tail = 0;
+    if (!que) return 0;
+
+    head = __atomic_load_n(&que->head, __ATOMIC_ACQUIRE);
+    tail = __atomic_load_n(&que->tail, __ATOMIC_ACQUIRE);
+
+    return tail > head ? tail - head : 0;
+}
@@ -0,0 +1,133 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    bounded lock-free multi-producer/multi-consumer ring queue
+*****************************************************/
+
+#ifndef __MINIDS_MPMCQUEUE_H__
+#define __MINIDS_MPMCQUEUE_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_MPMC_SPIN     128 /* retries before blocking call yield cpu */
+
+/* one slot, 'seq' tells whose turn the slot is */
+struct m_mpmcslot {
+    size_t seq;
+    void *elem;
+};
+
+/********************************************************
+ * @brief   mpmc queue struct define (Vyukov bounded queue)
+ *          every slot has a sequence number, slot 'i' is free for the
+ *          producer of position 'pos' when seq == pos and holds data for
+ *          the consumer of 'pos' when seq == pos + 1, so producers and
+ *          consumers only contend on their own position counter
+ * @array   slots, 'mask' + 1 of them
+ * @mask    capacity - 1, capacity is power of 2
+ * @allocator memory allocator of array, NULL for libc
+ * @tail    next position to enqueue, shared by producers
+ * @head    next position to dequeue, shared by consumers
+*********************************************************/
+struct m_mpmcqueue {
+    struct m_mpmcslot *array;
+    size_t mask;
+    struct m_allocator *allocator;
+    char pad0[64];
+    size_t tail;
+    char pad1[64];
+    size_t head;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   initialize queue
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2,
+ *          at least 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_mpmcqueue_init(struct m_mpmcqueue *que, size_t maxnum);
+
+/********************************************************
+ * @brief   initialize queue with a memory allocator
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2,
+ *          at least 2
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_mpmcqueue_init_alloc(struct m_mpmcqueue *que, size_t maxnum,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue and release its memory, free element by 'cbk',
+ *          all producers and consumers must be stopped
+ * @que     queue instance addr
+ * @cbk     memory free callback, iterate all element
+ *          NOTE! if NULL may cause memory leak
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_mpmcqueue_free(struct m_mpmcqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   enqueue an new element if queue is not full, thread safe
+ * @que     queue instance addr
+ * @elem    the new element, not NULL
+ * @return  0 sucess, M_ETOOMANY if queue is full
+********************************************************/
+int m_mpmcqueue_try_enque(struct m_mpmcqueue *que, void *elem);
+
+/********************************************************
+ * @brief   dequeue if queue is not empty, thread safe
+ * @que     queue instance addr
+ * @return  element addr, NULL if queue is empty
+*********************************************************/
+void *m_mpmcqueue_try_deque(struct m_mpmcqueue *que);
+
+/*******************************************************
+ * @brief   enqueue an new element, wait while queue is full, spin
+ *          M_MPMC_SPIN times then yield cpu between retries
+ * @que     queue instance addr
+ * @elem    the new element, not NULL
+ * @return  0 sucess, M_Exxx otherwise
+********************************************************/
+int m_mpmcqueue_enque(struct m_mpmcqueue *que, void *elem);
+
+/********************************************************
+ * @brief   dequeue, wait while queue is empty, spin M_MPMC_SPIN times
+ *          then yield cpu between retries
+ * @que     queue instance addr
+ * @return  element addr, NULL if 'que' is invalid
+*********************************************************/
+void *m_mpmcqueue_deque(struct m_mpmcqueue *que);
+
+/********************************************************
+ * @brief   get numbers of element in queue, a snapshot under concurrency
+ * @que     queue instance addr
+ * @return  numbers of element
+*********************************************************/
+size_t m_mpmcqueue_num(struct m_mpmcqueue *que);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,270 @@
+
+#include "multiqueue.h"
+
+/* trylock attempts on random sub-queues before fall back to blocking */
+#define MQ_TRIES    8
+
+/* per thread xorshift random */
+static unsigned int mq_rand(void)
+{
+    static __thread unsigned int seed = 0;
+    if (!seed)
+        seed = (unsigned int)(size_t)&seed | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/* pop head of 'q', locked by caller */
+static void *mq_pop_node(struct m_mqnode *q)
+{
+    void *elem = m_heap_pop(&q->heap);
+    __atomic_store_n(&q->num, q->heap.num, __ATOMIC_RELAXED);
+    return elem;
+}
+
+/* sub-queue with better head of 'a' and 'b', both locked by caller */
+static struct m_mqnode *mq_better(struct m_multiqueue *mq,
+                    struct m_mqnode *a, struct m_mqnode *b)
+{
+    void *ea = m_heap_peek(&a->heap);
+    void *eb = m_heap_peek(&b->heap);
+
+    if (!ea)
+        return eb ? b : NULL;
+    if (!eb)
+        return a;
+    if (M_HEAP_BEFORE(mq->type, a->heap.compare(eb, ea, a->heap.udt)))
+        return b;
+    return a;
+}
+
+static void mq_lock_all(struct m_multiqueue *mq)
+{
+    size_t i = 0;
+    for (i = 0; i < mq->nqueue; i++)
+        pthread_mutex_lock(&mq->queues[i].lock);
+}
+
+static void mq_unlock_all(struct m_multiqueue *mq)
+{
+    size_t i = mq->nqueue;
+    while (i-- > 0)
+        pthread_mutex_unlock(&mq->queues[i].lock);
+}
+
+/* sub-queue with best head of all, all locked by caller */
+static struct m_mqnode *mq_best(struct m_multiqueue *mq)
+{
+    size_t i = 0;
+    struct m_mqnode *best = NULL;
+
+    for (i = 0; i < mq->nqueue; i++) {
+        if (!mq->queues[i].heap.num)
+            continue;
+        if (!best)
+            best = &mq->queues[i];
+        else
+            best = mq_better(mq, best, &mq->queues[i]);
+    }
+
+    return best;
+}
+
+int m_multiqueue_init(struct m_multiqueue *mq, int type, int mode,
+                size_t nqueue,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt)
+{
+    return m_multiqueue_init_alloc(mq, type, mode, nqueue, compare, udt,
+                    NULL);
+}
+
+int m_multiqueue_init_alloc(struct m_multiqueue *mq, int type, int mode,
+                size_t nqueue,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt,
+                struct m_allocator *allocator)
+{
+    size_t i = 0;
+    int ret = 0;
+    if (!mq || (type != M_HEAP_MIN && type != M_HEAP_MAX) ||
+        (mode != M_MQ_RELAXED && mode != M_MQ_STRICT) || nqueue < 2 ||
+        !compare)
+        return M_EINVAL;
+
+    mq->queues = (struct m_mqnode *)M_ALLOC(allocator,
+                    sizeof(struct m_mqnode) * nqueue);
+    if (!mq->queues)
+        return M_EMALLOC;
+
+    for (i = 0; i < nqueue; i++) {
+        ret = m_heap_init_alloc(&mq->queues[i].heap, type, M_HEAP_INC, 64,
+                        compare, udt, allocator);
+        if (ret) {
+            while (i-- > 0) {
+                m_heap_free(&mq->queues[i].heap, NULL, NULL);
+                pthread_mutex_destroy(&mq->queues[i].lock);
+            }
+            M_FREE(allocator, mq->queues);
+            mq->queues = NULL;
+            return ret;
+        }
+        pthread_mutex_init(&mq->queues[i].lock, NULL);
+        mq->queues[i].num = 0;
+    }
+
+    mq->type = type;
+    mq->mode = mode;
+    mq->nqueue = nqueue;
+    mq->num = 0;
+    mq->allocator = allocator;
+
+    return 0;
+}
+
+void m_multiqueue_free(struct m_multiqueue *mq,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    size_t i = 0;
+    if (!mq || !mq->queues) return;
+
+    for (i = 0; i < mq->nqueue; i++) {
+        m_heap_free(&mq->queues[i].heap, cbk, udt);
+        pthread_mutex_destroy(&mq->queues[i].lock);
+    }
+    M_FREE(mq->allocator, mq->queues);
+    mq->queues = NULL;
+    mq->allocator = NULL;
+    mq->nqueue = 0;
+    mq->num = 0;
+}
+
+int m_multiqueue_insert(struct m_multiqueue *mq, void *elem)
+{
+    int ret = 0;
+    int tries = 0;
+    struct m_mqnode *q = NULL;
+    if (!mq || !elem) return M_EINVAL;
+
+    /* any sub-queue will do, skip busy ones */
+    for (;;) {
+        q = &mq->queues[mq_rand() % mq->nqueue];
+        if (tries++ < MQ_TRIES) {
+            if (pthread_mutex_trylock(&q->lock) == 0)
+                break;
+        } else {
+            pthread_mutex_lock(&q->lock);
+            break;
+        }
+    }
+    /* count first, a pop may take the element as soon as lock is released */
+    __atomic_add_fetch(&mq->num, 1, __ATOMIC_RELEASE);
+    ret = m_heap_insert(&q->heap, elem);
+    if (ret)
+        __atomic_sub_fetch(&mq->num, 1, __ATOMIC_RELEASE);
+    else
+        __atomic_store_n(&q->num, q->heap.num, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&q->lock);
+
+    return ret;
+}
+
+void *m_multiqueue_peek(struct m_multiqueue *mq)
+{
+    void *elem = NULL;
+    struct m_mqnode *best = NULL;
+    if (!mq) return NULL;
+
+    mq_lock_all(mq);
+    best = mq_best(mq);
+    if (best)
+        elem = m_heap_peek(&best->heap);
+    mq_unlock_all(mq);
+
+    return elem;
+}
+
+static void *mq_pop_strict(struct m_multiqueue *mq)
+{
+    void *elem = NULL;
+    struct m_mqnode *best = NULL;
+
+    mq_lock_all(mq);
+    best = mq_best(mq);
+    if (best)
+        elem = mq_pop_node(best);
+    mq_unlock_all(mq);
+
+    return elem;
+}
+
+static void *mq_pop_relaxed(struct m_multiqueue *mq)
+{
+    size_t i = 0;
+    size_t j = 0;
+    int tries = 0;
+    void *elem = NULL;
+    struct m_mqnode *qi = NULL;
+    struct m_mqnode *qj = NULL;
+    struct m_mqnode *best = NULL;
+
+    while (__atomic_load_n(&mq->num, __ATOMIC_ACQUIRE) > 0) {
+        /* pop better head of two random sub-queues */
+        for (tries = 0; tries < MQ_TRIES; tries++) {
+            i = mq_rand() % mq->nqueue;
+            j = mq_rand() % (mq->nqueue - 1);
+            if (j >= i)
+                j++;
+            qi = &mq->queues[i];
+            qj = &mq->queues[j];
+            if (pthread_mutex_trylock(&qi->lock))
+                continue;
+            if (pthread_mutex_trylock(&qj->lock)) {
+                pthread_mutex_unlock(&qi->lock);
+                continue;
+            }
+            best = mq_better(mq, qi, qj);
+            if (best)
+                elem = mq_pop_node(best);
+            pthread_mutex_unlock(&qj->lock);
+            pthread_mutex_unlock(&qi->lock);
+            if (elem)
+                return elem;
+        }
+
+        /* random sub-queues are busy or empty, take any one */
+        for (i = 0; i < mq->nqueue; i++) {
+            qi = &mq->queues[i];
+            if (!__atomic_load_n(&qi->num, __ATOMIC_RELAXED))
+                continue;
+            pthread_mutex_lock(&qi->lock);
+            elem = mq_pop_node(qi);
+            pthread_mutex_unlock(&qi->lock);
+            if (elem)
+                return elem;
+        }
+    }
+
+    return NULL;
+}
+
+void *m_multiqueue_pop(struct m_multiqueue *mq)
+{
+    void *elem = NULL;
+    if (!mq) return NULL;
+
+    if (mq->mode == M_MQ_STRICT)
+        elem = mq_pop_strict(mq);
+    else
+        elem = mq_pop_relaxed(mq);
+
+    if (elem)
+        __atomic_sub_fetch(&mq->num, 1, __ATOMIC_RELEASE);
+
+    return elem;
+}
+
+size_t m_multiqueue_num(struct m_multiqueue *mq)
+{
+    return mq ? __atomic_load_n(&mq->num, __ATOMIC_ACQUIRE) : 0;
+}
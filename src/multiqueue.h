@@ -0,0 +1,139 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    concurrent priority queue (MultiQueue of m_heap)
+*****************************************************/
+
+#ifndef __MINIDS_MULTIQUEUE_H__
+#define __MINIDS_MULTIQUEUE_H__
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "heap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_MQ_RELAXED    0 /* pop best of two random sub-queues */
+#define M_MQ_STRICT     1 /* pop global best, lock all sub-queues */
+
+/* one sub-queue, padded to avoid false sharing with its neighbours */
+struct m_mqnode {
+    pthread_mutex_t lock;
+    struct m_heap heap;
+    size_t num;     /* heap.num copy, written under lock, read without */
+    char pad[64];
+};
+
+/********************************************************
+ * @brief   concurrent priority queue struct define
+ *          elements are spread over 'nqueue' locked m_heap, insert goes
+ *          to a random sub-queue, pop takes the better head of two random
+ *          sub-queues (relaxed) or the best head of all (strict)
+ * @type    M_HEAP_MIN or M_HEAP_MAX
+ * @mode    M_MQ_RELAXED or M_MQ_STRICT
+ *          RELAXED: pop return one of the best ~nqueue elements, scale
+ *          with threads, good for schedulers
+ *          STRICT: pop always return the best element, every pop lock
+ *          all sub-queues so it does not scale
+ * @nqueue  numbers of sub-queue, 2-4 times of threads is suggested
+ * @num     counts of element in queue, raised before an element is
+ *          visible and dropped after it is popped, so it never wraps
+ * @queues  sub-queues
+ * @allocator memory allocator of sub-queues, NULL for libc
+*********************************************************/
+struct m_multiqueue {
+    int type;
+    int mode;
+    size_t nqueue;
+    size_t num;
+    struct m_mqnode *queues;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize concurrent priority queue
+ * @mq      queue instance addr
+ * @type    M_HEAP_MIN or M_HEAP_MAX
+ * @mode    M_MQ_RELAXED or M_MQ_STRICT
+ * @nqueue  numbers of sub-queue, at least 2
+ * @compare callback function compare two element sequence,
+ *          same as m_heap_init()
+ * @udt     opaque param pass to callback
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_multiqueue_init(struct m_multiqueue *mq, int type, int mode,
+                size_t nqueue,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt);
+
+/********************************************************
+ * @brief   initialize concurrent priority queue with a memory allocator,
+ *          see m_multiqueue_init()
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ *          and be thread safe
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_multiqueue_init_alloc(struct m_multiqueue *mq, int type, int mode,
+                size_t nqueue,
+                int (*compare)(void *elem1, void *elem2, void *udt), void *udt,
+                struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue, free memory by 'cbk', must not called concurrently
+ *          with other functions
+ * @mq      queue instance addr
+ * @cbk     memory free callback, iterate all element
+ *          NOTE! if NULL may cause memory leak
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_multiqueue_free(struct m_multiqueue *mq,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   insert an new element, thread safe
+ * @mq      queue instance addr
+ * @elem    the new element
+ * @return  0 sucess, M_Exxx otherwise
+********************************************************/
+int m_multiqueue_insert(struct m_multiqueue *mq, void *elem);
+
+/********************************************************
+ * @brief   peek queue head, thread safe
+ * @mq      queue instance addr
+ * @return  head element, NULL if empty
+ *          NOTE! element may be poped by other thread at once, caller
+ *          must make sure it is still valid before use it
+*********************************************************/
+void *m_multiqueue_peek(struct m_multiqueue *mq);
+
+/********************************************************
+ * @brief   pop queue head, thread safe
+ * @mq      queue instance addr
+ * @return  head element, NULL if empty
+*********************************************************/
+void *m_multiqueue_pop(struct m_multiqueue *mq);
+
+/********************************************************
+ * @brief   get counts of element in queue
+ * @mq      queue instance addr
+ * @return  counts of element
+*********************************************************/
+size_t m_multiqueue_num(struct m_multiqueue *mq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    power of 2 capacity helper shared by ring containers
+*****************************************************/
+
+#ifndef __MINIDS_POW2_H__
+#define __MINIDS_POW2_H__
+
+#include <stdlib.h>
+
+#ifndef inline
+#define inline __inline
+#endif
+
+/* largest power of 2 a size_t holds */
+#define M_POW2_MAX  (((size_t)-1 >> 1) + 1)
+
+/********************************************************
+ * @brief   round 'n' up to a power of 2, at least 'min'
+ * @n       wanted capacity
+ * @min     smallest capacity, must be a power of 2
+ * @return  capacity, 0 if 'n' is larger than M_POW2_MAX
+*********************************************************/
+static inline size_t m_pow2_roundup(size_t n, size_t min)
+{
+    size_t cap = min;
+
+    if (n > M_POW2_MAX)
+        return 0;
+    while (cap < n)
+        cap <<= 1;
+
+    return cap;
+}
+
+#endif
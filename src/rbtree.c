@@ -1,6 +1,7 @@
 
 
 #include "rbtree.h"
+#include "treewalk.h"
 
 #ifndef inline
 #define inline __inline
@@ -470,6 +471,14 @@ void m_rbtree_inorder(struct m_rbtree *tree,
     return rbtree_inorder(tree->offset, tree->root, cbk, udt);
 }
 
+void m_rbtree_inorder_prefetch(struct m_rbtree *tree,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    if (!tree || !cbk) return;
+
+    M_TREE_INORDER_PREFETCH(struct m_rbnode, tree->root, tree->offset, cbk, udt);
+}
+
 static void rbree_preorder(size_t offset, struct m_rbnode *node,
                     void (*cbk)(void *elem, void *udt), void *udt)
 {
@@ -0,0 +1,110 @@
+
+#include "recqueue.h"
+#include "pow2.h"
+
+#define REC(que,i) ((que)->array + ((i) & (que)->mask) * (que)->size)
+
+int m_recqueue_init(struct m_recqueue *que, size_t size, size_t maxnum)
+{
+    return m_recqueue_init_alloc(que, size, maxnum, NULL);
+}
+
+int m_recqueue_init_alloc(struct m_recqueue *que, size_t size,
+                    size_t maxnum, struct m_allocator *allocator)
+{
+    size_t cap = 0;
+    if (!que || size <= 0 || maxnum <= 0) return M_EINVAL;
+
+    /* size * cap must not wrap to a small array */
+    cap = m_pow2_roundup(maxnum, 1);
+    if (!cap || cap > (size_t)-1 / size)
+        return M_EINVAL;
+    que->array = (char *)M_ALLOC(allocator, size * cap);
+    if (!que->array)
+        return M_EMALLOC;
+    que->size = size;
+    que->mask = cap - 1;
+    que->allocator = allocator;
+    que->tail = que->headcache = 0;
+    que->head = que->tailcache = 0;
+
+    return 0;
+}
+
+void m_recqueue_free(struct m_recqueue *que,
+                    void (*cbk)(void *rec, void *udt), void *udt)
+{
+    if (!que || !que->array) return;
+
+    for ( ; que->head != que->tail; que->head++)
+        if (cbk) cbk(REC(que, que->head), udt);
+    M_FREE(que->allocator, que->array);
+    que->array = NULL;
+    que->allocator = NULL;
+    que->size = 0;
+    que->mask = 0;
+    que->tail = que->headcache = 0;
+    que->head = que->tailcache = 0;
+}
+
+void *m_recqueue_reserve(struct m_recqueue *que, size_t n, size_t *num)
+{
+    size_t tail = 0;
+    size_t room = 0;
+    if (!que || !num) return NULL;
+
+    tail = que->tail;
+    room = que->mask + 1 - (tail - que->headcache);
+    if (room < n) {
+        que->headcache = __atomic_load_n(&que->head, __ATOMIC_ACQUIRE);
+        room = que->mask + 1 - (tail - que->headcache);
+    }
+    /* stop at the end of the ring */
+    if (room > que->mask + 1 - (tail & que->mask))
+        room = que->mask + 1 - (tail & que->mask);
+    *num = room < n ? room : n;
+
+    return *num ? REC(que, tail) : NULL;
+}
+
+void m_recqueue_commit(struct m_recqueue *que, size_t n)
+{
+    if (!que) return;
+
+    __atomic_store_n(&que->tail, que->tail + n, __ATOMIC_RELEASE);
+}
+
+void *m_recqueue_peek(struct m_recqueue *que, size_t n, size_t *num)
+{
+    size_t head = 0;
+    size_t avail = 0;
+    if (!que || !num) return NULL;
+
+    head = que->head;
+    avail = que->tailcache - head;
+    if (avail < n) {
+        que->tailcache = __atomic_load_n(&que->tail, __ATOMIC_ACQUIRE);
+        avail = que->tailcache - head;
+    }
+    if (avail > que->mask + 1 - (head & que->mask))
+        avail = que->mask + 1 - (head & que->mask);
+    *num = avail < n ? avail : n;
+
+    return *num ? REC(que, head) : NULL;
+}
+
+void m_recqueue_release(struct m_recqueue *que, size_t n)
+{
+    if (!que) return;
+
+    __atomic_store_n(&que->head, que->head + n, __ATOMIC_RELEASE);
+}
+
+size_t m_recqueue_num(struct m_recqueue *que)
+{
+    size_t head = 0;
+    if (!que) return 0;
+
+    head = __atomic_load_n(&que->head, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&que->tail, __ATOMIC_ACQUIRE) - head;
+}
@@ -0,0 +1,132 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    fixed-size record ring queue, records are stored inline
+*****************************************************/
+
+#ifndef __MINIDS_RECQUEUE_H__
+#define __MINIDS_RECQUEUE_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/********************************************************
+ * @brief   record queue struct define
+ *          records of 'size' bytes live in the ring itself, producer
+ *          reserve slots and write them in place then commit, consumer
+ *          peek slots and read them in place then release, no copy and
+ *          no allocation per record
+ *          one producer thread and one consumer thread may run without
+ *          lock, same scheme as m_spscqueue
+ * @array   memory of 'mask' + 1 records
+ * @size    bytes of one record
+ * @mask    capacity - 1, capacity is power of 2
+ * @allocator memory allocator of array, NULL for libc
+ * @tail    next record to write, written by producer only
+ * @headcache producer's copy of head
+ * @head    next record to read, written by consumer only
+ * @tailcache consumer's copy of tail
+*********************************************************/
+struct m_recqueue {
+    char *array;
+    size_t size;
+    size_t mask;
+    struct m_allocator *allocator;
+    char pad0[64];
+    size_t tail;
+    size_t headcache;
+    char pad1[64];
+    size_t head;
+    size_t tailcache;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   initialize queue
+ * @que     queue instance addr
+ * @size    bytes of one record, record 'i' is at array + i * size, use a
+ *          multiple of the record alignment
+ * @maxnum  max numbers of record in queue, rounded up to power of 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_recqueue_init(struct m_recqueue *que, size_t size, size_t maxnum);
+
+/********************************************************
+ * @brief   initialize queue with a memory allocator, see m_recqueue_init()
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_recqueue_init_alloc(struct m_recqueue *que, size_t size,
+                    size_t maxnum, struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue and release its memory, producer and consumer
+ *          must be stopped
+ * @que     queue instance addr
+ * @cbk     callback of every committed but not released record, may be
+ *          NULL
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_recqueue_free(struct m_recqueue *que,
+                    void (*cbk)(void *rec, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   reserve up to 'n' free records to write, producer only
+ * @que     queue instance addr
+ * @n       wanted numbers of record
+ * @num     granted numbers of record, contiguous in memory, less than
+ *          'n' when queue is nearly full or at the end of the ring
+ * @return  first granted record, NULL if queue is full
+********************************************************/
+void *m_recqueue_reserve(struct m_recqueue *que, size_t n, size_t *num);
+
+/*******************************************************
+ * @brief   publish first 'n' reserved records to consumer, producer only
+ * @que     queue instance addr
+ * @n       numbers of record written, not more than granted
+********************************************************/
+void m_recqueue_commit(struct m_recqueue *que, size_t n);
+
+/*******************************************************
+ * @brief   get up to 'n' committed records to read, consumer only
+ * @que     queue instance addr
+ * @n       wanted numbers of record
+ * @num     granted numbers of record, contiguous in memory
+ * @return  first granted record, NULL if queue is empty
+********************************************************/
+void *m_recqueue_peek(struct m_recqueue *que, size_t n, size_t *num);
+
+/*******************************************************
+ * @brief   give first 'n' peeked records back to producer, consumer only
+ * @que     queue instance addr
+ * @n       numbers of record consumed, not more than granted
+********************************************************/
+void m_recqueue_release(struct m_recqueue *que, size_t n);
+
+/********************************************************
+ * @brief   get numbers of committed record in queue
+ * @que     queue instance addr
+ * @return  numbers of record
+*********************************************************/
+size_t m_recqueue_num(struct m_recqueue *que);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+#include "segqueue.h"
+
+int m_segqueue_init(struct m_segqueue *que, size_t segnum, size_t maxcache)
+{
+    return m_segqueue_init_alloc(que, segnum, maxcache, NULL);
+}
+
+int m_segqueue_init_alloc(struct m_segqueue *que, size_t segnum,
+                    size_t maxcache, struct m_allocator *allocator)
+{
+    if (!que || segnum <= 0) return M_EINVAL;
+
+    que->head = que->tail = NULL;
+    que->cache = NULL;
+    que->segnum = segnum;
+    que->num = 0;
+    que->nseg = 0;
+    que->ncache = 0;
+    que->maxcache = maxcache;
+    que->allocator = allocator;
+
+    return 0;
+}
+
+/* get a segment from cache or allocator */
+static struct m_segment *seg_get(struct m_segqueue *que)
+{
+    struct m_segment *seg = que->cache;
+
+    if (seg) {
+        que->cache = seg->next;
+        que->ncache--;
+    } else {
+        seg = (struct m_segment *)M_ALLOC(que->allocator,
+                    sizeof(struct m_segment) +
+                    sizeof(void *) * (que->segnum - 1));
+        if (!seg)
+            return NULL;
+    }
+    seg->next = NULL;
+    seg->head = seg->tail = 0;
+
+    return seg;
+}
+
+/* give a drained segment back to cache, or free it if cache is full */
+static void seg_put(struct m_segqueue *que, struct m_segment *seg)
+{
+    if (que->ncache < que->maxcache) {
+        seg->next = que->cache;
+        que->cache = seg;
+        que->ncache++;
+    } else {
+        M_FREE(que->allocator, seg);
+    }
+}
+
+void m_segqueue_trim(struct m_segqueue *que)
+{
+    struct m_segment *seg = NULL;
+    if (!que) return;
+
+    while ((seg = que->cache) != NULL) {
+        que->cache = seg->next;
+        M_FREE(que->allocator, seg);
+    }
+    que->ncache = 0;
+}
+
+void m_segqueue_free(struct m_segqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    size_t i = 0;
+    struct m_segment *seg = NULL;
+    if (!que) return;
+
+    while ((seg = que->head) != NULL) {
+        for (i = seg->head; i < seg->tail; i++)
+            if (cbk) cbk(seg->elem[i], udt);
+        que->head = seg->next;
+        M_FREE(que->allocator, seg);
+    }
+    m_segqueue_trim(que);
+    que->tail = NULL;
+    que->num = 0;
+    que->nseg = 0;
+    que->allocator = NULL;
+}
+
+int m_segqueue_enque(struct m_segqueue *que, void *elem)
+{
+    struct m_segment *seg = NULL;
+    if (!que) return M_EINVAL;
+
+    seg = que->tail;
+    if (!seg || seg->tail == que->segnum) {
+        seg = seg_get(que);
+        if (!seg)
+            return M_EMALLOC;
+        if (que->tail)
+            que->tail->next = seg;
+        else
+            que->head = seg;
+        que->tail = seg;
+        que->nseg++;
+    }
+
+    seg->elem[seg->tail++] = elem;
+    que->num++;
+
+    return 0;
+}
+
+void *m_segqueue_deque(struct m_segqueue *que)
+{
+    void *em = NULL;
+    struct m_segment *seg = NULL;
+    if (!que || !que->head) return NULL;
+
+    seg = que->head;
+    if (seg->head == seg->tail)
+        return NULL;
+
+    em = seg->elem[seg->head++];
+    que->num--;
+
+    /* segment drained */
+    if (seg->head == seg->tail) {
+        if (seg == que->tail) {
+            /* last segment, rewind it in place */
+            seg->head = seg->tail = 0;
+        } else {
+            /* only the last segment may be partly filled */
+            que->head = seg->next;
+            que->nseg--;
+            seg_put(que, seg);
+        }
+    }
+
+    return em;
+}
+
+void *m_segqueue_peek(struct m_segqueue *que)
+{
+    struct m_segment *seg = NULL;
+    if (!que || !que->head) return NULL;
+
+    seg = que->head;
+    return seg->head < seg->tail ? seg->elem[seg->head] : NULL;
+}
@@ -0,0 +1,132 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    unbounded queue of linked fixed-size segments
+*****************************************************/
+
+#ifndef __MINIDS_SEGQUEUE_H__
+#define __MINIDS_SEGQUEUE_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/********************************************************
+ * @brief   segment, 'segnum' slots filled at 'tail' and drained at 'head'
+ * @next    next newer segment, or next cached segment
+ * @head    next slot to dequeue
+ * @tail    next slot to enqueue
+ * @elem    slots, allocated with the segment
+*********************************************************/
+struct m_segment {
+    struct m_segment *next;
+    size_t head;
+    size_t tail;
+    void *elem[1];
+};
+
+/********************************************************
+ * @brief   segmented queue struct define
+ *          queue grows by linking a new segment at tail when the last
+ *          one is full and shrinks by unlinking the head segment when it
+ *          is drained, elements are never moved or copied, drained
+ *          segments are kept in a cache up to 'maxcache' and reused
+ *          before allocating, so every operation is O(1) and memory
+ *          follow current depth
+ * @head    oldest segment, dequeue from it
+ * @tail    newest segment, enqueue into it
+ * @cache   stack of free segments
+ * @segnum  slots of one segment
+ * @num     numbers of element in queue
+ * @nseg    numbers of segment in queue
+ * @ncache  numbers of segment in cache
+ * @maxcache max numbers of segment in cache
+ * @allocator memory allocator of segments, NULL for libc
+*********************************************************/
+struct m_segqueue {
+    struct m_segment *head;
+    struct m_segment *tail;
+    struct m_segment *cache;
+    size_t segnum;
+    size_t num;
+    size_t nseg;
+    size_t ncache;
+    size_t maxcache;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize queue, no segment is allocated until first enqueue
+ * @que     queue instance addr
+ * @segnum  slots of one segment, such as 64 or 256
+ * @maxcache max numbers of drained segment kept for reuse, 0 free them
+ *          at once
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_segqueue_init(struct m_segqueue *que, size_t segnum, size_t maxcache);
+
+/********************************************************
+ * @brief   initialize queue with a memory allocator, see m_segqueue_init()
+ * @allocator allocator of segment memory, NULL for libc, must outlive
+ *          queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_segqueue_init_alloc(struct m_segqueue *que, size_t segnum,
+                    size_t maxcache, struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue and release all segments, cache included
+ * @que     queue instance addr
+ * @cbk     callback of every element in order, may be NULL
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_segqueue_free(struct m_segqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   enqueue an new element, never cover old one
+ * @que     queue instance addr
+ * @elem    the new element
+ * @return  0 sucess, M_EMALLOC if a new segment can not be allocated
+********************************************************/
+int m_segqueue_enque(struct m_segqueue *que, void *elem);
+
+/********************************************************
+ * @brief   dequeue
+ * @que     queue instance addr
+ * @return  element addr, NULL is error or empty queue
+*********************************************************/
+void *m_segqueue_deque(struct m_segqueue *que);
+
+/********************************************************
+ * @brief   get oldest element without dequeue
+ * @que     queue instance addr
+ * @return  element addr, NULL is error or empty queue
+*********************************************************/
+void *m_segqueue_peek(struct m_segqueue *que);
+
+/********************************************************
+ * @brief   release all cached segments
+ * @que     queue instance addr
+*********************************************************/
+void m_segqueue_trim(struct m_segqueue *que);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,287 @@
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+#include "shmqueue.h"
+#include "pow2.h"
+
+#define CACHELINE 64
+
+/* only the checked copies in handle, never fields of shared ctl */
+#define REC(que,i) ((que)->data + ((size_t)(i) & (que)->mask) * (que)->size)
+
+/* map 'len' bytes of 'fd' and set pointers of handle, 'ctl' is checked */
+static int shm_map(struct m_shmqueue *que, int fd, size_t len,
+                    struct m_shmctl *ctl)
+{
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return M_EMALLOC;
+
+    que->ctl = (struct m_shmctl *)p;
+    que->data = (char *)p + ctl->dataoff;
+    que->maplen = len;
+    que->size = (size_t)ctl->size;
+    que->mask = (size_t)ctl->mask;
+    /* ring may be in use already, caches start from shared counters */
+    que->headcache = __atomic_load_n(&que->ctl->head, __ATOMIC_ACQUIRE);
+    que->tailcache = __atomic_load_n(&que->ctl->tail, __ATOMIC_ACQUIRE);
+
+    return 0;
+}
+
+static void shm_close(struct m_shmqueue *que)
+{
+    if (que->fd >= 0)
+        close(que->fd);
+    if (que->efd[0] >= 0)
+        close(que->efd[0]);
+    if (que->efd[1] >= 0)
+        close(que->efd[1]);
+    que->fd = que->efd[0] = que->efd[1] = -1;
+}
+
+int m_shmqueue_create(struct m_shmqueue *que, size_t size, size_t maxnum)
+{
+    size_t cap = 0;
+    size_t off = 0;
+    struct m_shmctl ctl;
+    if (!que || size <= 0 || maxnum <= 0) return M_EINVAL;
+
+    cap = m_pow2_roundup(maxnum, 1);
+    off = (sizeof(struct m_shmctl) + CACHELINE - 1) & ~(size_t)(CACHELINE - 1);
+    if (!cap || cap > ((size_t)-1 - off) / size)
+        return M_EINVAL;
+
+    que->ctl = NULL;
+    que->fd = memfd_create("m_shmqueue", MFD_CLOEXEC);
+    que->efd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    que->efd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (que->fd < 0 || que->efd[0] < 0 || que->efd[1] < 0 ||
+        ftruncate(que->fd, off + size * cap) < 0) {
+        shm_close(que);
+        return M_EMALLOC;
+    }
+
+    /* control block is written through fd, so shm_map can read it */
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.magic = M_SHMQ_MAGIC;
+    ctl.size = size;
+    ctl.mask = cap - 1;
+    ctl.dataoff = off;
+    if (pwrite(que->fd, &ctl, sizeof(ctl), 0) != sizeof(ctl) ||
+        shm_map(que, que->fd, off + size * cap, &ctl)) {
+        shm_close(que);
+        return M_EMALLOC;
+    }
+
+    return 0;
+}
+
+/* check geometry of a peer's control block against the memfd size */
+static int shm_check(int fd, struct m_shmctl *ctl)
+{
+    struct stat st;
+
+    if (ctl->magic != M_SHMQ_MAGIC || ctl->size == 0)
+        return M_EINVAL;
+    /* capacity is a power of 2 and every value fits in size_t */
+    if (ctl->mask >= (size_t)-1 || (ctl->mask & (ctl->mask + 1)) ||
+        ctl->size > (size_t)-1 || ctl->dataoff > (size_t)-1 ||
+        ctl->dataoff < sizeof(struct m_shmctl))
+        return M_EINVAL;
+    /* dataoff + size * (mask + 1) without overflow */
+    if (ctl->mask + 1 > ((size_t)-1 - ctl->dataoff) / ctl->size)
+        return M_EINVAL;
+    if (fstat(fd, &st) < 0 || st.st_size < 0 ||
+        (uint64_t)st.st_size < ctl->dataoff + ctl->size * (ctl->mask + 1))
+        return M_EINVAL;
+
+    return 0;
+}
+
+int m_shmqueue_attach(struct m_shmqueue *que, int fd, int efd0, int efd1)
+{
+    struct m_shmctl ctl;
+    if (!que || fd < 0 || efd0 < 0 || efd1 < 0) return M_EINVAL;
+
+    if (pread(fd, &ctl, sizeof(ctl), 0) != sizeof(ctl) ||
+        shm_check(fd, &ctl))
+        return M_EINVAL;
+
+    que->ctl = NULL;
+    que->fd = dup(fd);
+    que->efd[0] = dup(efd0);
+    que->efd[1] = dup(efd1);
+    if (que->fd < 0 || que->efd[0] < 0 || que->efd[1] < 0 ||
+        shm_map(que, que->fd, (size_t)(ctl.dataoff +
+                    ctl.size * (ctl.mask + 1)), &ctl)) {
+        shm_close(que);
+        return M_EMALLOC;
+    }
+
+    return 0;
+}
+
+void m_shmqueue_free(struct m_shmqueue *que)
+{
+    if (!que || !que->ctl) return;
+
+    munmap(que->ctl, que->maplen);
+    shm_close(que);
+    que->ctl = NULL;
+    que->data = NULL;
+    que->maplen = 0;
+    que->size = 0;
+    que->mask = 0;
+}
+
+/* wake peer parked on 'efd' if its flag is set */
+static void shm_notify(uint32_t *flag, int efd)
+{
+    unsigned long long one = 1;
+
+    /* pairs with fence in shm_park, counter store is seen or flag is */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(flag, __ATOMIC_RELAXED))
+        if (write(efd, &one, sizeof(one)) < 0)
+            return;
+}
+
+int m_shmqueue_enque(struct m_shmqueue *que, const void *rec)
+{
+    uint64_t tail = 0;
+    struct m_shmctl *ctl = NULL;
+    if (!que || !rec) return M_EINVAL;
+
+    ctl = que->ctl;
+    tail = ctl->tail;
+    if (tail - que->headcache > que->mask) {
+        que->headcache = __atomic_load_n(&ctl->head, __ATOMIC_ACQUIRE);
+        if (tail - que->headcache > que->mask)
+            return M_ETOOMANY;
+    }
+
+    memcpy(REC(que, tail), rec, que->size);
+    __atomic_store_n(&ctl->tail, tail + 1, __ATOMIC_RELEASE);
+    shm_notify(&ctl->rwait, que->efd[0]);
+
+    return 0;
+}
+
+int m_shmqueue_deque(struct m_shmqueue *que, void *rec)
+{
+    uint64_t head = 0;
+    struct m_shmctl *ctl = NULL;
+    if (!que || !rec) return M_EINVAL;
+
+    ctl = que->ctl;
+    head = ctl->head;
+    if (head == que->tailcache) {
+        que->tailcache = __atomic_load_n(&ctl->tail, __ATOMIC_ACQUIRE);
+        if (head == que->tailcache)
+            return M_ENOTFOUND;
+    }
+
+    memcpy(rec, REC(que, head), que->size);
+    __atomic_store_n(&ctl->head, head + 1, __ATOMIC_RELEASE);
+    shm_notify(&ctl->wwait, que->efd[1]);
+
+    return 0;
+}
+
+/* milliseconds left until 'deadline', -1 if 'deadline' is NULL */
+static int shm_left(struct timespec *deadline)
+{
+    long ms = 0;
+    struct timespec ts;
+    if (!deadline)
+        return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ms = (deadline->tv_sec - ts.tv_sec) * 1000 +
+         (deadline->tv_nsec - ts.tv_nsec) / 1000000;
+    return ms > 0 ? (int)ms : 0;
+}
+
+/* one try of enque if 'put', of deque otherwise */
+static int shm_try(struct m_shmqueue *que, int put, void *rec)
+{
+    return put ? m_shmqueue_enque(que, rec) : m_shmqueue_deque(que, rec);
+}
+
+/********************************************************
+ * @brief   retry until queue is not full if 'put', not empty otherwise,
+ *          parking on eventfd in between, wait flag is raised before the
+ *          last retry so peer either sees it or its update is seen by
+ *          that retry
+ * @return  result of last try, M_ETOOMANY or M_ENOTFOUND if timed out
+*********************************************************/
+static int shm_park(struct m_shmqueue *que, int put, void *rec, int timeout)
+{
+    int busy = put ? M_ETOOMANY : M_ENOTFOUND;
+    uint32_t *flag = put ? &que->ctl->wwait : &que->ctl->rwait;
+    int efd = que->efd[put ? 1 : 0];
+    int ret = 0;
+    int left = 0;
+    unsigned long long cnt = 0;
+    struct pollfd pfd;
+    struct timespec deadline;
+
+    if (timeout >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    while ((ret = shm_try(que, put, rec)) == busy) {
+        __atomic_store_n(flag, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if ((ret = shm_try(que, put, rec)) != busy)
+            break;
+
+        left = shm_left(timeout >= 0 ? &deadline : NULL);
+        if (left == 0)
+            break;
+        pfd.fd = efd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, left) < 0 && errno != EINTR) {
+            ret = M_EUNKNOWN;
+            break;
+        }
+        if (read(efd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+            ret = M_EUNKNOWN;
+            break;
+        }
+        __atomic_store_n(flag, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(flag, 0, __ATOMIC_RELAXED);
+
+    return ret;
+}
+
+int m_shmqueue_enque_wait(struct m_shmqueue *que, const void *rec,
+                    int timeout)
+{
+    if (!que || !rec) return M_EINVAL;
+
+    return shm_park(que, 1, (void *)rec, timeout);
+}
+
+int m_shmqueue_deque_wait(struct m_shmqueue *que, void *rec, int timeout)
+{
+    if (!que || !rec) return M_EINVAL;
+
+    return shm_park(que, 0, rec, timeout);
+}
@@ -0,0 +1,158 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    shared memory ring queue for cross-process spsc transfer
+*****************************************************/
+
+#ifndef __MINIDS_SHMQUEUE_H__
+#define __MINIDS_SHMQUEUE_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_SHMQ_MAGIC    0x4d534851 /* "MSHQ" */
+
+/********************************************************
+ * @brief   control block at start of the shared mapping, it holds only
+ *          counters and offsets, never pointers, so every process may
+ *          map it at its own address, records start 'dataoff' bytes
+ *          after it, fields are fixed width and padded by hand, so 32 and
+ *          64 bit peers see the same layout, tail and head each own a
+ *          cache line
+ *          'size', 'mask' and 'dataoff' are read once by create and
+ *          attach, a peer rewriting them later changes nothing here
+ * @magic   M_SHMQ_MAGIC, checked by attach
+ * @size    bytes of one record
+ * @mask    capacity - 1, capacity is power of 2
+ * @dataoff offset of first record from start of mapping
+ * @tail    next record to write, written by producer only
+ * @rwait   1 while consumer is parked on efd[0]
+ * @head    next record to read, written by consumer only
+ * @wwait   1 while producer is parked on efd[1]
+*********************************************************/
+struct m_shmctl {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t mask;
+    uint64_t dataoff;
+    char pad0[32];
+    uint64_t tail;
+    uint32_t rwait;
+    char pad1[52];
+    uint64_t head;
+    uint32_t wwait;
+    char pad2[52];
+};
+
+/********************************************************
+ * @brief   per process handle of a shared queue
+ *          one process enqueue and one process dequeue without lock,
+ *          records are copied in and out, a blocked side parks on an
+ *          eventfd, the other side only writes it when the parked flag
+ *          is set, so the hot path is syscall free
+ * @ctl     control block in mapping
+ * @data    first record in mapping
+ * @maplen  bytes of mapping
+ * @size    bytes of one record, checked copy of ctl
+ * @mask    capacity - 1, checked copy of ctl
+ * @fd      memfd of mapping, pass it with efd to the peer process by
+ *          fork or SCM_RIGHTS, then m_shmqueue_attach()
+ * @efd     eventfd, [0] signal records ready, [1] signal space ready
+ * @headcache producer's copy of head
+ * @tailcache consumer's copy of tail
+*********************************************************/
+struct m_shmqueue {
+    struct m_shmctl *ctl;
+    char *data;
+    size_t maplen;
+    size_t size;
+    size_t mask;
+    int fd;
+    int efd[2];
+    uint64_t headcache;
+    uint64_t tailcache;
+};
+
+/********************************************************
+ * @brief   create a shared queue in a new memfd mapping
+ * @que     queue handle addr
+ * @size    bytes of one record
+ * @maxnum  max numbers of record in queue, rounded up to power of 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_shmqueue_create(struct m_shmqueue *que, size_t size, size_t maxnum);
+
+/********************************************************
+ * @brief   attach to a shared queue created by another process, the fds
+ *          are duplicated, caller still owns its own fds
+ * @que     queue handle addr
+ * @fd      memfd of queue, 'fd' of creator's handle
+ * @efd0    'efd[0]' of creator's handle
+ * @efd1    'efd[1]' of creator's handle
+ * @return  0 success, M_EINVAL if control block is bad or the memfd is
+ *          smaller than it claims, M_EXXX otherwise
+*********************************************************/
+int m_shmqueue_attach(struct m_shmqueue *que, int fd, int efd0, int efd1);
+
+/*******************************************************
+ * @brief   unmap queue and close fds of this handle, the queue itself
+ *          live until every process freed its handle
+ * @que     queue handle addr
+********************************************************/
+void m_shmqueue_free(struct m_shmqueue *que);
+
+/*******************************************************
+ * @brief   copy a record into queue, producer only
+ * @que     queue handle addr
+ * @rec     record of 'size' bytes
+ * @return  0 sucess, M_ETOOMANY if queue is full
+********************************************************/
+int m_shmqueue_enque(struct m_shmqueue *que, const void *rec);
+
+/********************************************************
+ * @brief   copy a record out of queue, consumer only
+ * @que     queue handle addr
+ * @rec     buffer of 'size' bytes
+ * @return  0 sucess, M_ENOTFOUND if queue is empty
+*********************************************************/
+int m_shmqueue_deque(struct m_shmqueue *que, void *rec);
+
+/*******************************************************
+ * @brief   copy a record into queue, park while queue is full
+ * @que     queue handle addr
+ * @rec     record of 'size' bytes
+ * @timeout max wait in milliseconds, -1 wait forever
+ * @return  0 sucess, M_ETOOMANY if timed out, M_EUNKNOWN on wait error
+********************************************************/
+int m_shmqueue_enque_wait(struct m_shmqueue *que, const void *rec,
+                    int timeout);
+
+/********************************************************
+ * @brief   copy a record out of queue, park while queue is empty
+ * @que     queue handle addr
+ * @rec     buffer of 'size' bytes
+ * @timeout max wait in milliseconds, -1 wait forever
+ * @return  0 sucess, M_ENOTFOUND if timed out, M_EUNKNOWN on wait error
+*********************************************************/
+int m_shmqueue_deque_wait(struct m_shmqueue *que, void *rec, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+
+#include "spscqueue.h"
+#include "pow2.h"
+
+int m_spscqueue_init(struct m_spscqueue *que, size_t maxnum)
+{
+    return m_spscqueue_init_alloc(que, maxnum, NULL);
+}
+
+int m_spscqueue_init_alloc(struct m_spscqueue *que, size_t maxnum,
+                    struct m_allocator *allocator)
+{
+    size_t cap = 0;
+    if (!que || maxnum <= 0) return M_EINVAL;
+
+    cap = m_pow2_roundup(maxnum, 1);
+    if (!cap || cap > (size_t)-1 / sizeof(struct m_quenode))
+        return M_EINVAL;
+    que->array = (struct m_quenode *)M_ALLOC(allocator,
+                    sizeof(struct m_quenode) * cap);
+    if (!que->array)
+        return M_EMALLOC;
+    que->mask = cap - 1;
+    que->allocator = allocator;
+    que->tail = que->headcache = 0;
+    que->head = que->tailcache = 0;
+
+    return 0;
+}
+
+void m_spscqueue_free(struct m_spscqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    if (!que || !que->array) return;
+
+    for ( ; que->head != que->tail; que->head++)
+        if (cbk) cbk(que->array[que->head & que->mask].elem, udt);
+    M_FREE(que->allocator, que->array);
+    que->array = NULL;
+    que->allocator = NULL;
+    que->mask = 0;
+    que->tail = que->headcache = 0;
+    que->head = que->tailcache = 0;
+}
+
+int m_spscqueue_enque(struct m_spscqueue *que, void *elem)
+{
+    size_t tail = 0;
+    if (!que) return M_EINVAL;
+
+    tail = que->tail;
+    if (tail - que->headcache > que->mask) {
+        que->headcache = __atomic_load_n(&que->head, __ATOMIC_ACQUIRE);
+        if (tail - que->headcache > que->mask)
+            return M_ETOOMANY;
+    }
+
+    que->array[tail & que->mask].elem = elem;
+    __atomic_store_n(&que->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void *m_spscqueue_deque(struct m_spscqueue *que)
+{
+    void *elem = NULL;
+    size_t head = 0;
+    if (!que) return NULL;
+
+    head = que->head;
+    if (head == que->tailcache) {
+        que->tailcache = __atomic_load_n(&que->tail, __ATOMIC_ACQUIRE);
+        if (head == que->tailcache)
+            return NULL;
+    }
+
+    elem = que->array[head & que->mask].elem;
+    __atomic_store_n(&que->head, head + 1, __ATOMIC_RELEASE);
+
+    return elem;
+}
+
+size_t m_spscqueue_num(struct m_spscqueue *que)
+{
+    size_t head = 0;
+    if (!que) return 0;
+
+    /* head first, tail never falls behind it */
+    head = __atomic_load_n(&que->head, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&que->tail, __ATOMIC_ACQUIRE) - head;
+}
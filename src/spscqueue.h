@@ -0,0 +1,113 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    lock-free single-producer/single-consumer ring queue
+*****************************************************/
+
+#ifndef __MINIDS_SPSCQUEUE_H__
+#define __MINIDS_SPSCQUEUE_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+#include "circlequeue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/********************************************************
+ * @brief   spsc queue struct define
+ *          one thread enqueue and one other thread dequeue without lock,
+ *          head and tail are free running counters published with
+ *          release/acquire, each side owns one cache line and caches the
+ *          other side's counter so it only touches the other line when
+ *          queue looks full or empty
+ * @array   memory to store element, 'mask' + 1 slots
+ * @mask    capacity - 1, capacity is power of 2
+ * @allocator memory allocator of array, NULL for libc
+ * @tail    next slot to write, written by producer only
+ * @headcache producer's copy of head
+ * @head    next slot to read, written by consumer only
+ * @tailcache consumer's copy of tail
+*********************************************************/
+struct m_spscqueue {
+    struct m_quenode *array;
+    size_t mask;
+    struct m_allocator *allocator;
+    char pad0[64];
+    size_t tail;
+    size_t headcache;
+    char pad1[64];
+    size_t head;
+    size_t tailcache;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   initialize queue
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_spscqueue_init(struct m_spscqueue *que, size_t maxnum);
+
+/********************************************************
+ * @brief   initialize queue with a memory allocator
+ * @que     queue instance addr
+ * @maxnum  max numbers of element in queue, rounded up to power of 2
+ * @allocator allocator of queue memory, NULL for libc, must outlive queue
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_spscqueue_init_alloc(struct m_spscqueue *que, size_t maxnum,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset queue and release its memory, free element by 'cbk',
+ *          producer and consumer must be stopped
+ * @que     queue instance addr
+ * @cbk     memory free callback, iterate all element
+ *          NOTE! if NULL may cause memory leak
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_spscqueue_free(struct m_spscqueue *que,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   enqueue an new element, producer thread only
+ * @que     queue instance addr
+ * @elem    the new element
+ * @return  0 sucess, M_ETOOMANY if queue is full
+********************************************************/
+int m_spscqueue_enque(struct m_spscqueue *que, void *elem);
+
+/********************************************************
+ * @brief   dequeue, consumer thread only
+ * @que     queue instance addr
+ * @return  element addr, NULL if queue is empty
+*********************************************************/
+void *m_spscqueue_deque(struct m_spscqueue *que);
+
+/********************************************************
+ * @brief   get numbers of element in queue, exact only when called
+ *          by producer or consumer and the other side is idle
+ * @que     queue instance addr
+ * @return  numbers of element
+*********************************************************/
+size_t m_spscqueue_num(struct m_spscqueue *que);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
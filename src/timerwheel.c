@@ -0,0 +1,258 @@
+
+#include "timerwheel.h"
+
+#define TW_MASK     (M_TW_SLOTS - 1)
+#define TW_SPAN     (1UL << (M_TW_BITS * M_TW_LEVELS)) /* ticks in wheel */
+
+#define ELEM2TIMER(ELEM,OFFSET) ((struct m_timer *)((size_t)(ELEM) + (OFFSET)))
+#define TIMER2ELEM(TIMER,OFFSET) ((void *)((size_t)(TIMER) - (OFFSET)))
+
+static int cbk_compare(void *elem1, void *elem2, void *udt)
+{
+    struct m_timer *t1 = (struct m_timer *)elem1;
+    struct m_timer *t2 = (struct m_timer *)elem2;
+    if (t1->expire > t2->expire)
+        return 1;
+    else if (t1->expire < t2->expire)
+        return -1;
+    else
+        return 0;
+}
+
+static union m_heapkey cbk_getkey(void *elem, void *udt)
+{
+    union m_heapkey key;
+    key.i = (long long)((struct m_timer *)elem)->expire;
+    return key;
+}
+
+/* link timer into slot of its level, or into overflow heap,
+ * 'first' is the first tick whose slot is not run yet */
+static int tw_place(struct m_timerwheel *tw, struct m_timer *timer,
+                    unsigned long first)
+{
+    int level = 0;
+    unsigned long expire = timer->expire;
+    unsigned long delta = 0;
+    struct m_list *slot = NULL;
+
+    if (expire < first)
+        expire = first;
+    delta = expire - tw->now;
+
+    if (delta >= TW_SPAN) {
+        if (m_heap_insert(&tw->overflow, timer))
+            return M_EMALLOC;
+        timer->slot = NULL;
+        timer->state = M_TIMER_OVERFLOW;
+        return 0;
+    }
+
+    for (level = 0; level < M_TW_LEVELS - 1; level++)
+        if (delta < 1UL << (M_TW_BITS * (level + 1)))
+            break;
+    slot = &tw->slots[level][(expire >> (M_TW_BITS * level)) & TW_MASK];
+    m_list_append(slot, timer);
+    timer->slot = slot;
+    timer->state = M_TIMER_WHEEL;
+
+    return 0;
+}
+
+/* move timers of current slot at 'level' down to lower levels */
+static void tw_cascade(struct m_timerwheel *tw, int level)
+{
+    struct m_timer *timer = NULL;
+    struct m_list *slot =
+            &tw->slots[level][(tw->now >> (M_TW_BITS * level)) & TW_MASK];
+
+    while ((timer = (struct m_timer *)m_list_pop_head(slot)) != NULL)
+        tw_place(tw, timer, tw->now);
+}
+
+/* move overflow timers now inside wheel span into wheel */
+static void tw_refill(struct m_timerwheel *tw)
+{
+    struct m_timer *timer = NULL;
+
+    while ((timer = (struct m_timer *)m_heap_peek(&tw->overflow)) != NULL) {
+        if (timer->expire > tw->now && timer->expire - tw->now >= TW_SPAN)
+            break;
+        m_heap_pop(&tw->overflow);
+        tw_place(tw, timer, tw->now);
+    }
+}
+
+int m_timerwheel_init(struct m_timerwheel *tw, size_t offset,
+                    unsigned long now)
+{
+    return m_timerwheel_init_alloc(tw, offset, now, NULL);
+}
+
+int m_timerwheel_init_alloc(struct m_timerwheel *tw, size_t offset,
+                    unsigned long now, struct m_allocator *allocator)
+{
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+    if (!tw) return M_EINVAL;
+
+    ret = m_heap_init_alloc(&tw->overflow, M_HEAP_MIN,
+                    M_HEAP_INC | M_HEAP_SHRINK | M_HEAP_ARITY4, 64,
+                    cbk_compare, NULL, allocator);
+    if (ret)
+        return ret;
+    m_heap_set_index(&tw->overflow, M_HEAP_OFFSET(struct m_timer, heapidx));
+    ret = m_heap_set_key(&tw->overflow, M_HEAP_KEY_INT, cbk_getkey);
+    if (ret) {
+        m_heap_free(&tw->overflow, NULL, NULL);
+        return ret;
+    }
+
+    for (i = 0; i < M_TW_LEVELS; i++)
+        for (j = 0; j < M_TW_SLOTS; j++)
+            m_list_init(&tw->slots[i][j], M_LIST_OFFSET(struct m_timer, node));
+    tw->now = now;
+    tw->offset = offset;
+    tw->count = 0;
+
+    return 0;
+}
+
+void m_timerwheel_free(struct m_timerwheel *tw,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    int i = 0;
+    int j = 0;
+    struct m_timer *timer = NULL;
+    if (!tw) return;
+
+    for (i = 0; i < M_TW_LEVELS; i++) {
+        for (j = 0; j < M_TW_SLOTS; j++) {
+            while ((timer = m_list_pop_head(&tw->slots[i][j])) != NULL) {
+                timer->state = M_TIMER_IDLE;
+                timer->slot = NULL;
+                if (cbk) cbk(TIMER2ELEM(timer, tw->offset), udt);
+            }
+        }
+    }
+    while ((timer = (struct m_timer *)m_heap_pop(&tw->overflow)) != NULL) {
+        timer->state = M_TIMER_IDLE;
+        if (cbk) cbk(TIMER2ELEM(timer, tw->offset), udt);
+    }
+    m_heap_free(&tw->overflow, NULL, NULL);
+    tw->count = 0;
+}
+
+int m_timerwheel_add(struct m_timerwheel *tw, void *elem,
+                    unsigned long expire)
+{
+    int ret = 0;
+    struct m_timer *timer = NULL;
+    if (!tw || !elem) return M_EINVAL;
+
+    timer = ELEM2TIMER(elem, tw->offset);
+    if (timer->state != M_TIMER_IDLE)
+        return M_EEXISTS;
+    timer->expire = expire;
+    ret = tw_place(tw, timer, tw->now + 1);
+    if (ret)
+        return ret;
+    tw->count++;
+
+    return 0;
+}
+
+void m_timerwheel_timer_init(struct m_timer *timer)
+{
+    if (!timer) return;
+
+    timer->node.prev = timer->node.next = NULL;
+    timer->slot = NULL;
+    timer->heapidx = 0;
+    timer->expire = 0;
+    timer->state = M_TIMER_IDLE;
+}
+
+int m_timerwheel_cancel(struct m_timerwheel *tw, void *elem)
+{
+    struct m_timer *timer = NULL;
+    if (!tw || !elem) return M_EINVAL;
+
+    timer = ELEM2TIMER(elem, tw->offset);
+    if (timer->state == M_TIMER_WHEEL)
+        m_list_remove(timer->slot, timer);
+    else if (timer->state == M_TIMER_OVERFLOW)
+        m_heap_remove(&tw->overflow, timer);
+    else
+        return M_ENOTFOUND;
+
+    timer->state = M_TIMER_IDLE;
+    timer->slot = NULL;
+    tw->count--;
+
+    return 0;
+}
+
+int m_timerwheel_mod(struct m_timerwheel *tw, void *elem,
+                    unsigned long expire)
+{
+    if (!tw || !elem) return M_EINVAL;
+
+    m_timerwheel_cancel(tw, elem);
+    return m_timerwheel_add(tw, elem, expire);
+}
+
+int m_timerwheel_pending(struct m_timerwheel *tw, void *elem)
+{
+    if (!tw || !elem) return 0;
+
+    return ELEM2TIMER(elem, tw->offset)->state != M_TIMER_IDLE;
+}
+
+size_t m_timerwheel_advance(struct m_timerwheel *tw, unsigned long now,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    int level = 0;
+    size_t fired = 0;
+    struct m_list *slot = NULL;
+    struct m_timer *timer = NULL;
+    if (!tw) return 0;
+
+    while (tw->now < now) {
+        /* nothing pending, jump */
+        if (tw->count == 0) {
+            tw->now = now;
+            break;
+        }
+
+        tw->now++;
+        /* lower level wrapped, cascade upper level */
+        if ((tw->now & TW_MASK) == 0) {
+            for (level = 1; level < M_TW_LEVELS; level++) {
+                tw_cascade(tw, level);
+                if ((tw->now >> (M_TW_BITS * level)) & TW_MASK)
+                    break;
+            }
+            if (level == M_TW_LEVELS)
+                tw_refill(tw);
+        }
+
+        /* expire timers of current tick */
+        slot = &tw->slots[0][tw->now & TW_MASK];
+        while ((timer = (struct m_timer *)m_list_pop_head(slot)) != NULL) {
+            timer->state = M_TIMER_IDLE;
+            timer->slot = NULL;
+            tw->count--;
+            fired++;
+            if (cbk) cbk(TIMER2ELEM(timer, tw->offset), udt);
+        }
+    }
+
+    return fired;
+}
+
+size_t m_timerwheel_count(struct m_timerwheel *tw)
+{
+    return tw ? tw->count : 0;
+}
@@ -0,0 +1,184 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    hierarchical timing wheel
+*****************************************************/
+
+#ifndef __MINIDS_TIMERWHEEL_H__
+#define __MINIDS_TIMERWHEEL_H__
+
+#include <stdlib.h>
+
+#include "list.h"
+#include "heap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_TW_BITS       6                   /* slots of every level, log2 */
+#define M_TW_SLOTS      (1 << M_TW_BITS)
+#define M_TW_LEVELS     4                   /* wheel cover 2^24 ticks */
+
+#define M_TIMER_IDLE        0 /* timer not pending */
+#define M_TIMER_WHEEL       1 /* timer in a wheel slot */
+#define M_TIMER_OVERFLOW    2 /* timer in overflow heap */
+
+/*******************************************************
+ * @brief   calculate timer offset in element, just use for
+ *          m_timerwheel_init()
+ * @TYPE    element type
+ * @MEMBER  timer
+ * @sample  struct element {
+ *              int key;
+ *              struct m_timer timer;
+ *          }
+ *          M_TIMER_OFFSET(struct element, timer)
+********************************************************/
+#define M_TIMER_OFFSET(TYPE, MEMBER) ((size_t)&((TYPE *)0)->MEMBER)
+
+/********************************************************
+ * @brief   timer embedded in element, all fields are private
+ *          initialize it by m_timerwheel_timer_init() (or zero it) before
+ *          first use, cancel, mod and pending read its state
+ * @node    link in wheel slot
+ * @slot    wheel slot list timer is linked in
+ * @heapidx slot in overflow heap
+ * @expire  absolute expire tick
+ * @state   M_TIMER_IDLE, M_TIMER_WHEEL or M_TIMER_OVERFLOW
+*********************************************************/
+struct m_timer {
+    struct m_listnode node;
+    struct m_list *slot;
+    size_t heapidx;
+    unsigned long expire;
+    int state;
+};
+
+/********************************************************
+ * @brief   timing wheel struct define
+ *          M_TW_LEVELS levels of M_TW_SLOTS slots, slot of level L
+ *          cover 2^(M_TW_BITS*L) ticks, timers are moved down one level
+ *          when their slot is reached, timers beyond the top level
+ *          wait in an index mode m_heap ordered by expire tick
+ * @now     current tick
+ * @offset  timer offset in element
+ * @count   numbers of pending timer
+ * @slots   slot lists of every level
+ * @overflow far future timers
+*********************************************************/
+struct m_timerwheel {
+    unsigned long now;
+    size_t offset;
+    size_t count;
+    struct m_list slots[M_TW_LEVELS][M_TW_SLOTS];
+    struct m_heap overflow;
+};
+
+/********************************************************
+ * @brief   initialize timing wheel
+ * @tw      timing wheel instance addr
+ * @offset  timer offset in element, M_TIMER_OFFSET()
+ * @now     current tick
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_timerwheel_init(struct m_timerwheel *tw, size_t offset,
+                    unsigned long now);
+
+/********************************************************
+ * @brief   initialize timing wheel with a memory allocator of its
+ *          overflow heap, see m_timerwheel_init()
+ * @allocator allocator, NULL for libc, must outlive timing wheel
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_timerwheel_init_alloc(struct m_timerwheel *tw, size_t offset,
+                    unsigned long now, struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset timing wheel, free pending element by 'cbk'
+ * @tw      timing wheel instance addr
+ * @cbk     memory free callback, iterate all pending element
+ * @udt     opaque param pass to callback
+********************************************************/
+void m_timerwheel_free(struct m_timerwheel *tw,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   add a timer, O(1) (O(log n) for beyond 2^24 ticks)
+ * @tw      timing wheel instance addr
+ * @elem    element, its timer must be initialized
+ * @expire  absolute expire tick, if not after current tick,
+ *          timer expire at next tick
+ * @return  0 sucess, M_EEXISTS if timer is pending, M_Exxx otherwise
+********************************************************/
+int m_timerwheel_add(struct m_timerwheel *tw, void *elem,
+                    unsigned long expire);
+
+/*******************************************************
+ * @brief   initialize a timer as not pending, call it once before the
+ *          element is first used with a timing wheel
+ * @timer   timer in element
+********************************************************/
+void m_timerwheel_timer_init(struct m_timer *timer);
+
+/*******************************************************
+ * @brief   cancel a pending timer, O(1) (O(log n) if in overflow heap)
+ * @tw      timing wheel instance addr
+ * @elem    element
+ * @return  0 sucess, M_ENOTFOUND if timer is not pending
+********************************************************/
+int m_timerwheel_cancel(struct m_timerwheel *tw, void *elem);
+
+/*******************************************************
+ * @brief   change expire tick of a timer, add it if not pending
+ * @tw      timing wheel instance addr
+ * @elem    element
+ * @expire  absolute expire tick
+ * @return  0 sucess, M_Exxx otherwise
+********************************************************/
+int m_timerwheel_mod(struct m_timerwheel *tw, void *elem,
+                    unsigned long expire);
+
+/*******************************************************
+ * @brief   check a timer is pending or not
+ * @tw      timing wheel instance addr
+ * @elem    element
+ * @return  1 pending, 0 otherwise
+********************************************************/
+int m_timerwheel_pending(struct m_timerwheel *tw, void *elem);
+
+/*******************************************************
+ * @brief   advance wheel to tick 'now', callback every expired element
+ *          in expire order, cost O(1) per tick plus expired timers
+ * @tw      timing wheel instance addr
+ * @now     new current tick
+ * @cbk     callback of expired element, timer is idle when called, it
+ *          may add/cancel any timer of this wheel
+ * @udt     opaque param pass to callback
+ * @return  numbers of expired element
+********************************************************/
+size_t m_timerwheel_advance(struct m_timerwheel *tw, unsigned long now,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   get numbers of pending timer
+ * @tw      timing wheel instance addr
+ * @return  numbers of pending timer
+********************************************************/
+size_t m_timerwheel_count(struct m_timerwheel *tw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+#include "tracering.h"
+#include "pow2.h"
+
+/* bytes of a record of 'len' bytes payload in ring */
+#define RECSIZE(len) (sizeof(struct m_tracerec) + (((len) + 7) & ~(size_t)7))
+
+static unsigned long long trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* copy 'n' bytes to or from ring at 'pos', split at the end */
+static void trace_copy(struct m_tracebuf *buf, size_t pos, void *mem,
+                    size_t n, int toring)
+{
+    size_t off = pos & buf->mask;
+    size_t first = buf->mask + 1 - off;
+    if (first > n)
+        first = n;
+
+    if (toring) {
+        memcpy(buf->data + off, mem, first);
+        memcpy(buf->data, (char *)mem + first, n - first);
+    } else {
+        memcpy(mem, buf->data + off, first);
+        memcpy((char *)mem + first, buf->data, n - first);
+    }
+}
+
+int m_tracering_init(struct m_tracering *trace, size_t nbuf, size_t size)
+{
+    return m_tracering_init_alloc(trace, nbuf, size, NULL);
+}
+
+int m_tracering_init_alloc(struct m_tracering *trace, size_t nbuf,
+                    size_t size, struct m_allocator *allocator)
+{
+    size_t i = 0;
+    size_t cap = 0;
+    struct m_tracebuf *buf = NULL;
+    if (!trace || nbuf <= 0 || size <= 0) return M_EINVAL;
+
+    cap = m_pow2_roundup(size, 64);
+    if (!cap || nbuf > (size_t)-1 / sizeof(struct m_tracebuf *))
+        return M_EINVAL;
+    trace->allocator = allocator;
+    trace->nbuf = nbuf;
+    trace->bufs = (struct m_tracebuf **)M_ALLOC(allocator,
+                    sizeof(struct m_tracebuf *) * nbuf);
+    if (!trace->bufs)
+        return M_EMALLOC;
+    memset(trace->bufs, 0, sizeof(struct m_tracebuf *) * nbuf);
+
+    for (i = 0; i < nbuf; i++) {
+        buf = (struct m_tracebuf *)M_ALLOC(allocator,
+                    sizeof(struct m_tracebuf));
+        if (!buf) {
+            m_tracering_free(trace);
+            return M_EMALLOC;
+        }
+        memset(buf, 0, sizeof(struct m_tracebuf));
+        trace->bufs[i] = buf;
+        buf->mask = cap - 1;
+        buf->data = (char *)M_ALLOC(allocator, cap);
+        /* reader copy, a record is never larger than ring */
+        buf->rec = (struct m_tracerec *)M_ALLOC(allocator, cap);
+        if (!buf->data || !buf->rec) {
+            m_tracering_free(trace);
+            return M_EMALLOC;
+        }
+    }
+
+    return 0;
+}
+
+void m_tracering_free(struct m_tracering *trace)
+{
+    size_t i = 0;
+    struct m_tracebuf *buf = NULL;
+    if (!trace || !trace->bufs) return;
+
+    for (i = 0; i < trace->nbuf; i++) {
+        buf = trace->bufs[i];
+        if (!buf)
+            continue;
+        if (buf->data)
+            M_FREE(trace->allocator, buf->data);
+        if (buf->rec)
+            M_FREE(trace->allocator, buf->rec);
+        M_FREE(trace->allocator, buf);
+    }
+    M_FREE(trace->allocator, trace->bufs);
+    trace->bufs = NULL;
+    trace->nbuf = 0;
+    trace->allocator = NULL;
+}
+
+struct m_tracebuf *m_tracering_attach(struct m_tracering *trace)
+{
+    size_t i = 0;
+    int unused = 0;
+    if (!trace) return NULL;
+
+    for (i = 0; i < trace->nbuf; i++) {
+        unused = 0;
+        if (__atomic_compare_exchange_n(&trace->bufs[i]->used, &unused, 1,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return trace->bufs[i];
+    }
+
+    return NULL;
+}
+
+void m_tracering_detach(struct m_tracebuf *buf)
+{
+    if (!buf) return;
+
+    /* records written so far are visible before reader may free ring */
+    __atomic_store_n(&buf->used, 2, __ATOMIC_RELEASE);
+}
+
+int m_tracering_write(struct m_tracebuf *buf, unsigned int type,
+                    const void *data, size_t len)
+{
+    size_t need = 0;
+    size_t tail = 0;
+    size_t head = 0;
+    size_t covers = 0;
+    struct m_tracerec rec;
+    if (!buf || (!data && len)) return M_EINVAL;
+
+    need = RECSIZE(len);
+    if (need > buf->mask + 1)
+        return M_ETOOMANY;
+
+    tail = buf->tail;
+    head = buf->head;
+    /* cover oldest records until new one fits */
+    while (tail + need - head > buf->mask + 1) {
+        trace_copy(buf, head, &rec, sizeof(rec), 0);
+        head += RECSIZE(rec.len);
+        covers++;
+    }
+    if (covers) {
+        __atomic_store_n(&buf->covers, buf->covers + covers,
+                    __ATOMIC_RELAXED);
+        __atomic_store_n(&buf->head, head, __ATOMIC_RELAXED);
+        /* new head is visible before covered bytes change */
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    rec.ts = trace_now();
+    rec.len = (unsigned int)len;
+    rec.type = type;
+    trace_copy(buf, tail, &rec, sizeof(rec), 1);
+    trace_copy(buf, tail + sizeof(rec), (void *)data, len, 1);
+    __atomic_store_n(&buf->tail, tail + need, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/* copy next record of 'buf' before 'rend' into 'rec', skip covered ones */
+static void trace_fill(struct m_tracebuf *buf)
+{
+    size_t head = 0;
+    size_t len = 0;
+
+    buf->ready = 0;
+    for (;;) {
+        head = __atomic_load_n(&buf->head, __ATOMIC_ACQUIRE);
+        if ((ptrdiff_t)(head - buf->rpos) > 0)
+            buf->rpos = head;
+        if ((ptrdiff_t)(buf->rend - buf->rpos) <= 0)
+            return;
+
+        trace_copy(buf, buf->rpos, buf->rec, sizeof(struct m_tracerec), 0);
+        len = buf->rec->len;
+        if (RECSIZE(len) <= buf->mask + 1)
+            trace_copy(buf, buf->rpos + sizeof(struct m_tracerec),
+                    buf->rec + 1, len, 0);
+
+        /* copy is good if writer has not covered it meanwhile */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&buf->head, __ATOMIC_RELAXED) == head) {
+            buf->ready = 1;
+            return;
+        }
+    }
+}
+
+int m_tracering_read(struct m_tracering *trace,
+                    int (*cbk)(const struct m_tracerec *rec, size_t idx,
+                    void *udt), void *udt)
+{
+    int num = 0;
+    size_t i = 0;
+    size_t min = 0;
+    struct m_tracebuf *buf = NULL;
+    if (!trace || !cbk) return M_EINVAL;
+
+    for (i = 0; i < trace->nbuf; i++) {
+        buf = trace->bufs[i];
+        buf->rend = __atomic_load_n(&buf->tail, __ATOMIC_ACQUIRE);
+        trace_fill(buf);
+    }
+
+    /* k-way merge, rings are few so a scan finds the oldest */
+    for (;;) {
+        min = trace->nbuf;
+        for (i = 0; i < trace->nbuf; i++)
+            if (trace->bufs[i]->ready && (min == trace->nbuf ||
+                trace->bufs[i]->rec->ts < trace->bufs[min]->rec->ts))
+                min = i;
+        if (min == trace->nbuf)
+            break;
+
+        buf = trace->bufs[min];
+        buf->rpos += RECSIZE(buf->rec->len);
+        num++;
+        if (cbk(buf->rec, min, udt))
+            return M_ECALLBACK;
+        trace_fill(buf);
+    }
+
+    /* a detached ring read to its end is free for next attach */
+    for (i = 0; i < trace->nbuf; i++) {
+        buf = trace->bufs[i];
+        if (__atomic_load_n(&buf->used, __ATOMIC_ACQUIRE) == 2 &&
+            buf->rpos == __atomic_load_n(&buf->tail, __ATOMIC_RELAXED))
+            __atomic_store_n(&buf->used, 0, __ATOMIC_RELEASE);
+    }
+
+    return num;
+}
+
+size_t m_tracering_covers(struct m_tracering *trace)
+{
+    size_t i = 0;
+    size_t num = 0;
+    if (!trace) return 0;
+
+    for (i = 0; i < trace->nbuf; i++)
+        num += __atomic_load_n(&trace->bufs[i]->covers, __ATOMIC_RELAXED);
+
+    return num;
+}
@@ -0,0 +1,173 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    per-thread overwrite trace rings with merging reader
+*****************************************************/
+
+#ifndef __MINIDS_TRACERING_H__
+#define __MINIDS_TRACERING_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+/********************************************************
+ * @brief   record header, payload of 'len' bytes follow it, records are
+ *          8 bytes aligned in ring
+ * @ts      CLOCK_MONOTONIC time of write in ns
+ * @len     bytes of payload
+ * @type    caller defined record type
+*********************************************************/
+struct m_tracerec {
+    unsigned long long ts;
+    unsigned int len;
+    unsigned int type;
+};
+
+/********************************************************
+ * @brief   ring of one writer thread
+ *          writer appends at 'tail', when ring is full the oldest
+ *          records are covered like m_cirqueue_enque() does, writer
+ *          moves 'head' past them before writing over them, reader
+ *          copies a record then checks 'head' again to detect cover
+ *          writer fields and reader fields are on their own cache lines
+ *          and every ring is a separate allocation, so writers never
+ *          share a cache line
+ * @data    memory of 'mask' + 1 bytes
+ * @mask    capacity - 1, capacity is power of 2
+ * @tail    end of last record, written by writer only
+ * @head    start of oldest record, written by writer only
+ * @covers  numbers of record covered, written by writer only
+ * @used    0 free, 1 attached to a writer, 2 detached and waiting for
+ *          reader to drain it
+ * @rpos    next record to read, reader only
+ * @rend    end of records to read in current m_tracering_read()
+ * @rec     record copied by reader, valid when 'ready'
+ * @ready   1 if 'rec' hold the next record to merge
+*********************************************************/
+struct m_tracebuf {
+    char *data;
+    size_t mask;
+    char pad0[64];
+    size_t tail;
+    size_t head;
+    size_t covers;
+    char pad1[64];
+    int used;
+    size_t rpos;
+    size_t rend;
+    struct m_tracerec *rec;
+    int ready;
+    char pad2[64];
+};
+
+/********************************************************
+ * @brief   trace ring set struct define
+ * @bufs    one ring per writer thread
+ * @nbuf    numbers of ring
+ * @allocator memory allocator of rings, NULL for libc
+*********************************************************/
+struct m_tracering {
+    struct m_tracebuf **bufs;
+    size_t nbuf;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize 'nbuf' rings of 'size' bytes
+ * @trace   trace instance addr
+ * @nbuf    max numbers of writer thread
+ * @size    bytes of every ring, rounded up to power of 2
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_tracering_init(struct m_tracering *trace, size_t nbuf, size_t size);
+
+/********************************************************
+ * @brief   initialize with a memory allocator, see m_tracering_init()
+ * @allocator allocator of ring memory, NULL for libc, must outlive trace
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_tracering_init_alloc(struct m_tracering *trace, size_t nbuf,
+                    size_t size, struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   release all rings, writers and reader must be stopped
+ * @trace   trace instance addr
+********************************************************/
+void m_tracering_free(struct m_tracering *trace);
+
+/*******************************************************
+ * @brief   get a free ring for calling thread, keep it in thread local
+ *          storage and pass it to m_tracering_write()
+ * @trace   trace instance addr
+ * @return  ring addr, NULL if every ring is taken
+********************************************************/
+struct m_tracebuf *m_tracering_attach(struct m_tracering *trace);
+
+/*******************************************************
+ * @brief   give ring back when its thread exits, owner thread only, the
+ *          ring is free for m_tracering_attach() again after a
+ *          m_tracering_read() has read its last record, so records of a
+ *          gone thread are never lost to the next owner
+ *          NOTE! 'idx' of m_tracering_read() names a ring, not a thread,
+ *          a reused ring hold records of several threads in turn
+ * @buf     ring from m_tracering_attach(), must not be used after it
+********************************************************/
+void m_tracering_detach(struct m_tracebuf *buf);
+
+/*******************************************************
+ * @brief   append a record, never block, cover oldest records if full,
+ *          owner thread of 'buf' only
+ * @buf     ring from m_tracering_attach()
+ * @type    caller defined record type
+ * @data    payload, may be NULL if 'len' is 0
+ * @len     bytes of payload, header and payload must fit in the ring
+ * @return  0 sucess, M_ETOOMANY if record is larger than ring
+********************************************************/
+int m_tracering_write(struct m_tracebuf *buf, unsigned int type,
+                    const void *data, size_t len);
+
+/*******************************************************
+ * @brief   read records of all rings merged in timestamp order, only
+ *          records written before the call are read, one reader at a
+ *          time, may run with writers
+ *          NOTE! a record whose write overlaps the call may be read by
+ *          the next call, after records of other rings with later time
+ * @trace   trace instance addr
+ * @cbk     callback of every record, stop reading if not 0
+ *          @rec    record header, payload follow it
+ *          @idx    index of ring of record
+ *          @udt    opaque userdata
+ * @udt     opaque param pass to callback
+ * @return  numbers of record read, M_ECALLBACK if stopped by callback
+********************************************************/
+int m_tracering_read(struct m_tracering *trace,
+                    int (*cbk)(const struct m_tracerec *rec, size_t idx,
+                    void *udt), void *udt);
+
+/********************************************************
+ * @brief   get numbers of record covered in all rings
+ * @trace   trace instance addr
+ * @return  numbers of record
+*********************************************************/
+size_t m_tracering_covers(struct m_tracering *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    prefetching inorder walk shared by rbtree and avltree
+*****************************************************/
+
+#ifndef __MINIDS_TREEWALK_H__
+#define __MINIDS_TREEWALK_H__
+
+#include <stddef.h>
+
+/* rbtree height is at most 2 * log2(n + 1), avltree under 1.45 * log2(n + 2),
+ * 128 levels are plenty for both */
+#define M_TREE_MAXDEPTH 128
+
+/********************************************************
+ * @brief   inorder walk without recursion, right child and element of
+ *          every node are prefetched when the node is pushed, so they
+ *          are in cache once its left subtree is done
+ * @NTYPE   node type, has 'left' and 'right' members
+ * @ROOT    root node
+ * @OFFSET  offset of node in element
+ * @CBK     callback function use for return every element
+ * @UDT     opaque pram pass to callback
+*********************************************************/
+#define M_TREE_INORDER_PREFETCH(NTYPE, ROOT, OFFSET, CBK, UDT) \
+do { \
+    int top_ = 0; \
+    NTYPE *node_ = (ROOT); \
+    NTYPE *stack_[M_TREE_MAXDEPTH]; \
+    while (node_ || top_ > 0) { \
+        for ( ; node_; node_ = node_->left) { \
+            __builtin_prefetch(node_->right); \
+            __builtin_prefetch((void *)((size_t)node_ - (OFFSET))); \
+            stack_[top_++] = node_; \
+        } \
+        node_ = stack_[--top_]; \
+        (CBK)((void *)((size_t)node_ - (OFFSET)), (UDT)); \
+        node_ = node_->right; \
+    } \
+} while (0)
+
+#endif
@@ -0,0 +1,340 @@
+#include <string.h>
+
+#include "ulist.h"
+
+#define CHUNKSIZE(cap) (sizeof(struct m_ulchunk) + sizeof(void *) * ((cap) - 1))
+
+int m_ulist_init(struct m_ulist *list, size_t cap)
+{
+    return m_ulist_init_alloc(list, cap, NULL);
+}
+
+int m_ulist_init_alloc(struct m_ulist *list, size_t cap,
+                    struct m_allocator *allocator)
+{
+    if (!list) return M_EINVAL;
+    if (cap == 0)
+        cap = M_ULIST_CHUNK;
+    if (cap < 4) return M_EINVAL;
+
+    list->head = list->tail = NULL;
+    list->cap = cap;
+    list->length = 0;
+    list->nchunk = 0;
+    list->allocator = allocator;
+
+    return 0;
+}
+
+int m_ulist_free(struct m_ulist *list,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    size_t i = 0;
+    struct m_ulchunk *chunk = NULL;
+    struct m_ulchunk *next = NULL;
+    if (!list) return M_EINVAL;
+
+    for (chunk = list->head; chunk; chunk = next) {
+        next = chunk->next;
+        if (cbk)
+            for (i = 0; i < chunk->num; i++)
+                cbk(chunk->elem[i], udt);
+        M_FREE(list->allocator, chunk);
+    }
+    list->head = list->tail = NULL;
+    list->length = 0;
+    list->nchunk = 0;
+    list->allocator = NULL;
+
+    return 0;
+}
+
+/* new empty chunk linked after 'prev', or as head if 'prev' is NULL */
+static struct m_ulchunk *ul_new_chunk(struct m_ulist *list,
+                    struct m_ulchunk *prev)
+{
+    struct m_ulchunk *chunk = (struct m_ulchunk *)M_ALLOC(list->allocator,
+                    CHUNKSIZE(list->cap));
+    if (!chunk)
+        return NULL;
+
+    chunk->num = 0;
+    chunk->prev = prev;
+    chunk->next = prev ? prev->next : list->head;
+    if (chunk->next)
+        chunk->next->prev = chunk;
+    else
+        list->tail = chunk;
+    if (prev)
+        prev->next = chunk;
+    else
+        list->head = chunk;
+    list->nchunk++;
+
+    return chunk;
+}
+
+static void ul_del_chunk(struct m_ulist *list, struct m_ulchunk *chunk)
+{
+    if (chunk->prev)
+        chunk->prev->next = chunk->next;
+    else
+        list->head = chunk->next;
+    if (chunk->next)
+        chunk->next->prev = chunk->prev;
+    else
+        list->tail = chunk->prev;
+    M_FREE(list->allocator, chunk);
+    list->nchunk--;
+}
+
+/* chunk of element at position 'pos' (1..length), 'off' receive index */
+static struct m_ulchunk *ul_locate(struct m_ulist *list, size_t pos,
+                    size_t *off)
+{
+    size_t r = 0;
+    struct m_ulchunk *chunk = NULL;
+
+    if (pos <= list->length / 2) {
+        for (chunk = list->head; r + chunk->num < pos; chunk = chunk->next)
+            r += chunk->num;
+        *off = pos - r - 1;
+    } else {
+        /* r counts elements behind 'chunk' */
+        for (chunk = list->tail; r + chunk->num <= list->length - pos;
+                    chunk = chunk->prev)
+            r += chunk->num;
+        *off = chunk->num - (list->length - pos - r) - 1;
+    }
+
+    return chunk;
+}
+
+/* put 'elem' at 'off' of 'chunk', 'off' may be num, full chunk is split */
+static int ul_insert_at(struct m_ulist *list, struct m_ulchunk *chunk,
+                    size_t off, void *elem)
+{
+    size_t half = 0;
+    struct m_ulchunk *temp = NULL;
+
+    if (chunk->num == list->cap) {
+        /* at the edge of a full chunk try neighbour, else start new one,
+         * so append and prepend leave full chunks behind */
+        if (off == chunk->num && !(chunk->next &&
+                    chunk->next->num < list->cap)) {
+            chunk = ul_new_chunk(list, chunk);
+            off = 0;
+        } else if (off == chunk->num) {
+            chunk = chunk->next;
+            off = 0;
+        } else if (off == 0 && !(chunk->prev &&
+                    chunk->prev->num < list->cap)) {
+            chunk = ul_new_chunk(list, chunk->prev);
+        } else if (off == 0) {
+            chunk = chunk->prev;
+            off = chunk->num;
+        } else {
+            temp = ul_new_chunk(list, chunk);
+            if (!temp)
+                return M_EMALLOC;
+            half = chunk->num / 2;
+            memcpy(temp->elem, chunk->elem + half,
+                    sizeof(void *) * (chunk->num - half));
+            temp->num = chunk->num - half;
+            chunk->num = half;
+            if (off > half) {
+                chunk = temp;
+                off -= half;
+            }
+        }
+        if (!chunk)
+            return M_EMALLOC;
+    }
+
+    memmove(chunk->elem + off + 1, chunk->elem + off,
+                    sizeof(void *) * (chunk->num - off));
+    chunk->elem[off] = elem;
+    chunk->num++;
+    list->length++;
+
+    return 0;
+}
+
+/* take element at 'off' out of 'chunk', merge chunk under a quarter */
+static void *ul_delete_at(struct m_ulist *list, struct m_ulchunk *chunk,
+                    size_t off)
+{
+    void *elem = chunk->elem[off];
+    struct m_ulchunk *next = NULL;
+
+    chunk->num--;
+    memmove(chunk->elem + off, chunk->elem + off + 1,
+                    sizeof(void *) * (chunk->num - off));
+    list->length--;
+
+    if (chunk->num == 0) {
+        ul_del_chunk(list, chunk);
+    } else if (chunk->num < list->cap / 4) {
+        if (chunk->prev && chunk->prev->num + chunk->num <= list->cap)
+            chunk = chunk->prev;
+        next = chunk->next;
+        if (next && chunk->num + next->num <= list->cap) {
+            memcpy(chunk->elem + chunk->num, next->elem,
+                    sizeof(void *) * next->num);
+            chunk->num += next->num;
+            ul_del_chunk(list, next);
+        }
+    }
+
+    return elem;
+}
+
+int m_ulist_prepend(struct m_ulist *list, void *elem)
+{
+    if (!list) return M_EINVAL;
+
+    if (!list->head && !ul_new_chunk(list, NULL))
+        return M_EMALLOC;
+    return ul_insert_at(list, list->head, 0, elem);
+}
+
+int m_ulist_append(struct m_ulist *list, void *elem)
+{
+    if (!list) return M_EINVAL;
+
+    if (!list->tail && !ul_new_chunk(list, NULL))
+        return M_EMALLOC;
+    return ul_insert_at(list, list->tail, list->tail->num, elem);
+}
+
+size_t m_ulist_insert(struct m_ulist *list, void *elem, size_t pos)
+{
+    size_t off = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list) return 0;
+
+    if (pos < 1)
+        pos = 1;
+    if (pos > list->length)
+        return m_ulist_append(list, elem) ? 0 : list->length;
+
+    chunk = ul_locate(list, pos, &off);
+    return ul_insert_at(list, chunk, off, elem) ? 0 : pos;
+}
+
+int m_ulist_remove(struct m_ulist *list, void *elem)
+{
+    size_t i = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list) return M_EINVAL;
+
+    for (chunk = list->head; chunk; chunk = chunk->next)
+        for (i = 0; i < chunk->num; i++)
+            if (chunk->elem[i] == elem) {
+                ul_delete_at(list, chunk, i);
+                return 0;
+            }
+
+    return M_ENOTFOUND;
+}
+
+void *m_ulist_pop(struct m_ulist *list, size_t n)
+{
+    size_t off = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list || n < 1 || n > list->length) return NULL;
+
+    chunk = ul_locate(list, n, &off);
+    return ul_delete_at(list, chunk, off);
+}
+
+void *m_ulist_pop_head(struct m_ulist *list)
+{
+    if (!list || !list->head) return NULL;
+
+    return ul_delete_at(list, list->head, 0);
+}
+
+void *m_ulist_pop_tail(struct m_ulist *list)
+{
+    if (!list || !list->tail) return NULL;
+
+    return ul_delete_at(list, list->tail, list->tail->num - 1);
+}
+
+void *m_ulist_first(struct m_ulist *list)
+{
+    if (!list || !list->head) return NULL;
+
+    return list->head->elem[0];
+}
+
+void *m_ulist_last(struct m_ulist *list)
+{
+    if (!list || !list->tail) return NULL;
+
+    return list->tail->elem[list->tail->num - 1];
+}
+
+void *m_ulist_nth(struct m_ulist *list, size_t n)
+{
+    size_t off = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list || n < 1 || n > list->length) return NULL;
+
+    chunk = ul_locate(list, n, &off);
+    return chunk->elem[off];
+}
+
+void m_ulist_travarsal(struct m_ulist *list, int flag,
+                    void (*cbk)(void *elem, void *udt), void *udt)
+{
+    size_t i = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list || !cbk) return;
+
+    if (flag == 0) {
+        for (chunk = list->head; chunk; chunk = chunk->next)
+            for (i = 0; i < chunk->num; i++)
+                cbk(chunk->elem[i], udt);
+    } else {
+        for (chunk = list->tail; chunk; chunk = chunk->prev)
+            for (i = chunk->num; i > 0; i--)
+                cbk(chunk->elem[i - 1], udt);
+    }
+}
+
+size_t m_ulist_index(struct m_ulist *list, void *elem)
+{
+    size_t i = 0;
+    size_t r = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list) return 0;
+
+    for (chunk = list->head; chunk; r += chunk->num, chunk = chunk->next)
+        for (i = 0; i < chunk->num; i++)
+            if (chunk->elem[i] == elem)
+                return r + i + 1;
+
+    return 0;
+}
+
+size_t m_ulist_length(struct m_ulist *list)
+{
+    return list ? list->length : 0;
+}
+
+void *m_ulist_find(struct m_ulist *list, void *key,
+                int (*cbk)(void *elem, void *key, void *udt), void *udt)
+{
+    size_t i = 0;
+    struct m_ulchunk *chunk = NULL;
+    if (!list || !cbk) return NULL;
+
+    for (chunk = list->head; chunk; chunk = chunk->next)
+        for (i = 0; i < chunk->num; i++)
+            if (cbk(chunk->elem[i], key, udt) == 0)
+                return chunk->elem[i];
+
+    return NULL;
+}
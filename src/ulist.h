@@ -0,0 +1,209 @@
+/****************************************************
+* Copyright (c) 2019 dangqian All rights reserved.
+* @brief    unrolled list, chunks of element pointers
+*****************************************************/
+
+#ifndef __MINIDS_ULIST_H__
+#define __MINIDS_ULIST_H__
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MINIDS_ERROR
+#define MINIDS_ERROR
+#define M_EINVAL    (-1) /* invalid arguments */
+#define M_EUNKNOWN  (-2) /* unknown error */
+#define M_ENOTFOUND (-3) /* not found */
+#define M_EEXISTS   (-4) /* equal key of element already exist */
+#define M_ECALLBACK (-5) /* cbk function return error result */
+#define M_ETOOMANY  (-6) /* too many element */
+#define M_EMALLOC   (-7) /* memory allocate failed */
+#endif
+
+#define M_ULIST_CHUNK   32 /* default element pointers per chunk */
+
+/********************************************************
+ * @brief   chunk of list, 'elem' holds 'num' elements in order, the
+ *          array is allocated with 'cap' slots of m_ulist
+*********************************************************/
+struct m_ulchunk {
+    struct m_ulchunk *prev;
+    struct m_ulchunk *next;
+    size_t num;
+    void *elem[1];
+};
+
+/********************************************************
+ * @brief   unrolled list struct define
+ *          unlike m_list it is not intrusive, it keeps element pointers
+ *          in chunks of 'cap', so a scan reads whole cache lines of
+ *          pointers and takes one chunk miss per 'cap' elements, a full
+ *          chunk is split in halves on insert, a chunk below a quarter
+ *          is merged with its neighbour on remove
+ * @head    first chunk
+ * @tail    last chunk
+ * @cap     element pointers per chunk
+ * @length  numbers of element
+ * @nchunk  numbers of chunk
+ * @allocator memory allocator of chunks, NULL for libc
+*********************************************************/
+struct m_ulist {
+    struct m_ulchunk *head;
+    struct m_ulchunk *tail;
+    size_t cap;
+    size_t length;
+    size_t nchunk;
+    struct m_allocator *allocator;
+};
+
+/********************************************************
+ * @brief   initialize list instance
+ * @list    list instance addr
+ * @cap     element pointers per chunk, 0 for M_ULIST_CHUNK, at least 4
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_ulist_init(struct m_ulist *list, size_t cap);
+
+/********************************************************
+ * @brief   initialize list instance with a memory allocator, see
+ *          m_ulist_init()
+ * @allocator allocator of chunk memory, NULL for libc, must outlive list
+ * @return  0 success, M_EXXX otherwise
+*********************************************************/
+int m_ulist_init_alloc(struct m_ulist *list, size_t cap,
+                    struct m_allocator *allocator);
+
+/*******************************************************
+ * @brief   reset list instance and release chunks
+ * @list    list instance addr
+ * @cbk     callback of every element in order, may be NULL
+ * @udt     opaque param pass to callback
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_ulist_free(struct m_ulist *list,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   insert a new element into start of list
+ * @list    list instance addr
+ * @elem    the new element
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_ulist_prepend(struct m_ulist *list, void *elem);
+
+/*******************************************************
+ * @brief   insert a new element into end of list
+ * @list    list instance addr
+ * @elem    the new element
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_ulist_append(struct m_ulist *list, void *elem);
+
+/*******************************************************
+ * @brief   insert a new element at the give position
+ * @list    list instance addr
+ * @elem    the new element
+ * @pos     position, head pos is 1, if pos<1 will insert into start of
+ *          list, if pos larger than list length will insert into end
+ * @return  real inserted position, 0 otherwise
+********************************************************/
+size_t m_ulist_insert(struct m_ulist *list, void *elem, size_t pos);
+
+/*******************************************************
+ * @brief   remove first occurrence of an element from list
+ * @list    list instance addr
+ * @elem    the element
+ * @return  0 success, M_EXXX otherwise
+********************************************************/
+int m_ulist_remove(struct m_ulist *list, void *elem);
+
+/*******************************************************
+ * @brief   popup n-th element
+ * @list    list instance addr
+ * @n       n-th, first element is 1, if out of range will return NULL
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_pop(struct m_ulist *list, size_t n);
+
+/*******************************************************
+ * @brief   popup first element
+ * @list    list instance addr
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_pop_head(struct m_ulist *list);
+
+/*******************************************************
+ * @brief   popup last element
+ * @list    list instance addr
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_pop_tail(struct m_ulist *list);
+
+/*******************************************************
+ * @brief   get first element
+ * @list    list instance addr
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_first(struct m_ulist *list);
+
+/*******************************************************
+ * @brief   get last element
+ * @list    list instance addr
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_last(struct m_ulist *list);
+
+/*******************************************************
+ * @brief   get n-th element, it skips whole chunks
+ * @list    list instance addr
+ * @n       n-th, first element is 1, if out of range will return NULL
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_nth(struct m_ulist *list, size_t n);
+
+/*******************************************************
+ * @brief   traversal list forward or backward
+ * @list    list instance addr
+ * @flag    0 forward(traversal from head), 1 backward(traversal from tail)
+ * @cbk     callback function, callback each element
+ * @udt     opaque pram to callback
+********************************************************/
+void m_ulist_travarsal(struct m_ulist *list, int flag,
+                    void (*cbk)(void *elem, void *udt), void *udt);
+
+/*******************************************************
+ * @brief   get index of first occurrence of give element
+ * @list    list instance addr
+ * @elem    if element is not in list return 0
+ * @return  index, 0 not found
+********************************************************/
+size_t m_ulist_index(struct m_ulist *list, void *elem);
+
+/*******************************************************
+ * @brief   get list length
+ * @list    list instance addr
+ * @return  list length
+********************************************************/
+size_t m_ulist_length(struct m_ulist *list);
+
+/*******************************************************
+ * @brief   find an element by given key, see m_list_find()
+ * @list    list instance addr
+ * @key     key pass to callback
+ * @cbk     return 0 if it is element to look for, -1 otherwise
+ * @udt     opaque pram pass to callback
+ * @return  element addr, NULL otherwise
+********************************************************/
+void *m_ulist_find(struct m_ulist *list, void *key,
+                int (*cbk)(void *elem, void *key, void *udt), void *udt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,8 +12,15 @@ TARGET:=$(patsubst %.c,%.out, $(SRCS))
 
 all:$(TARGET)
 
+# modules built on other modules
+test_multiqueue.out: ../src/heap.o
+test_timerwheel.out: ../src/list.o ../src/heap.o
+test_blkqueue.out: ../src/mpmcqueue.o
+test_idxlist.out: ../src/list.o
+test_listhash.out: ../src/list.o
+
 %.out:%.o
-	$(CC) $(CFLAGS) -o $@ $< ../src/$(patsubst test_%.o,%.o, $<) $(LDFLAGS) $(LIBS)
+	$(CC) $(CFLAGS) -o $@ $^ ../src/$(patsubst test_%.o,%.o, $<) $(LDFLAGS) $(LIBS)
 
 %.o:%.c
 	$(CC) $(CFLAGS) -o $@ -c $< $(LDFLAGS) $(LIBS)
@@ -21,7 +28,7 @@ all:$(TARGET)
 %.d:%.c
 	@set -e; rm -f $@; \
 	$(CC) $(CFLAGS) -MM $< > $@.$$$$; \
-	sed -i 's/$$/ ..\/src\/$(patsubst test_%.c,%.c, $<)/' $@.$$$$; \
+	sed -i '$$s/$$/ ..\/src\/$(patsubst test_%.c,%.c, $<)/' $@.$$$$; \
 	sed 's,/($*/)/.o[ :]*,/1.o $@ : ,g' < $@.$$$$ > $@; \
 	rm -f $@.$$$$
 
@@ -90,6 +90,9 @@ int main()
     printf("inorder:");
     m_avltree_inorder(&tree, cbk_inoder, NULL);
     printf("\n");
+    printf("inorder_prefetch:");
+    m_avltree_inorder_prefetch(&tree, cbk_inoder, NULL);
+    printf("\n");
     /* test preorder */
     printf("preorder:");
     m_avltree_preorder(&tree, cbk_inoder, NULL);
@@ -0,0 +1,144 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "blkqueue.h"
+
+#define THREADS 3
+#define COUNT   100000
+
+struct element {
+    int key;
+    int producer;
+};
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(em);
+}
+
+static struct m_blkqueue que;
+static struct element elems[THREADS][COUNT];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *producer(void *arg)
+{
+    int i = 0;
+    struct element *em = (struct element *)arg;
+
+    for (i = 0; i < COUNT; i++)
+        m_blkqueue_enque_wait(&que, &em[i], -1);
+
+    return NULL;
+}
+
+/* count elements, check every producer's elements arrive in order */
+static void *consumer(void *arg)
+{
+    int i = 0;
+    long bad = 0;
+    int last[THREADS];
+    struct element *em = NULL;
+
+    for (i = 0; i < THREADS; i++)
+        last[i] = -1;
+    for (i = 0; i < COUNT; i++) {
+        em = (struct element *)m_blkqueue_deque_wait(&que, -1);
+        if (em->key <= last[em->producer])
+            bad++;
+        last[em->producer] = em->key;
+    }
+
+    return (void *)bad;
+}
+
+/* park first, get element pushed after a while */
+static void *late_producer(void *arg)
+{
+    struct timespec ts = {0, 50000000};
+
+    nanosleep(&ts, NULL);
+    m_blkqueue_enque(&que, arg);
+
+    return NULL;
+}
+
+int main()
+{
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+    long bad = 0;
+    double t = 0;
+    void *res = NULL;
+    struct element *temp = NULL;
+    pthread_t tids[THREADS * 2];
+
+    ret = m_blkqueue_init(&que, 64);
+    if (ret)
+        printf("m_blkqueue_init failed:%d\n", ret);
+    else
+        printf("m_blkqueue_init success, capacity:%d\n",
+                    (int)que.que.mask + 1);
+
+    /* timeouts on empty and full queue */
+    t = now();
+    temp = (struct element *)m_blkqueue_deque_wait(&que, 20);
+    t = now() - t;
+    printf("m_blkqueue_deque_wait empty:%p waited enough:%d\n", (void *)temp,
+                    t >= 0.019);
+    for (i = 0; i < 64; i++)
+        m_blkqueue_enque(&que, &elems[0][i]);
+    t = now();
+    ret = m_blkqueue_enque_wait(&que, &elems[0][64], 20);
+    t = now() - t;
+    printf("m_blkqueue_enque_wait full:%d waited enough:%d\n", ret,
+                    t >= 0.019);
+    while (m_blkqueue_deque(&que))
+        ;
+
+    /* parked consumer is woken */
+    elems[0][0].key = 42;
+    pthread_create(&tids[0], NULL, late_producer, &elems[0][0]);
+    temp = (struct element *)m_blkqueue_deque_wait(&que, -1);
+    pthread_join(tids[0], NULL);
+    printf("m_blkqueue_deque_wait woken:%d\n", temp->key);
+
+    /* producers and consumers block on each other */
+    for (i = 0; i < THREADS; i++)
+        for (j = 0; j < COUNT; j++) {
+            elems[i][j].key = j;
+            elems[i][j].producer = i;
+        }
+    for (i = 0; i < THREADS; i++) {
+        pthread_create(&tids[i], NULL, producer, elems[i]);
+        pthread_create(&tids[THREADS + i], NULL, consumer, NULL);
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_join(tids[i], NULL);
+        pthread_join(tids[THREADS + i], &res);
+        bad += (long)res;
+    }
+    printf("transfer %d elements, bad:%ld num:%d\n", THREADS * COUNT, bad,
+                    (int)m_blkqueue_num(&que));
+
+    for (i = 0; i < 3; i++) {
+        temp = (struct element *)malloc(sizeof(struct element));
+        temp->key = i;
+        m_blkqueue_enque(&que, temp);
+    }
+    m_blkqueue_free(&que, cbk_free, NULL);
+
+    return 0;
+}
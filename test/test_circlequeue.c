@@ -55,6 +55,53 @@ int main()
         }
     } while (temp);
 
+    /* bulk test, batch wraps and covers oldest element */
+    {
+        struct element *elms[14];
+        struct element *out[16];
+        for (i = 0; i < 14; i++) {
+            elms[i] = (struct element *)malloc(sizeof(struct element));
+            elms[i]->key = 100 + i;
+        }
+        ret = m_cirqueue_enque_bulk(&que, (void **)elms, 7, cbk_cover, NULL);
+        printf("m_cirqueue_enque_bulk 7:%d num:%d\n", ret, (int)que.num);
+        ret = m_cirqueue_enque_bulk(&que, (void **)&elms[7], 7, cbk_cover,
+                        NULL);
+        printf("m_cirqueue_enque_bulk 7:%d num:%d\n", ret, (int)que.num);
+        ret = (int)m_cirqueue_deque_bulk(&que, (void **)out, 16);
+        printf("m_cirqueue_deque_bulk %d:", ret);
+        for (i = 0; i < ret; i++) {
+            printf(" %d", out[i]->key);
+            free(out[i]);
+        }
+        printf("\n");
+    }
+
+#ifdef M_QUEUE_STATS
+    /* counters of everything above, then dwell of a fresh run */
+    {
+        struct m_questats st;
+        m_cirqueue_stats(&que, &st);
+        printf("stats enques:%d deques:%d covers:%d highwater:%d\n",
+                        (int)st.enques, (int)st.deques, (int)st.covers,
+                        (int)st.highwater);
+        m_cirqueue_stats_reset(&que);
+        for (i = 0; i < 1000; i++) {
+            m_cirqueue_enque(&que, &que, NULL, NULL);
+            if (i % 2)
+                m_cirqueue_deque(&que);
+        }
+        while (m_cirqueue_deque(&que))
+            ;
+        m_cirqueue_stats(&que, &st);
+        for (i = 0, ret = 0; i < M_QUEUE_HIST; i++)
+            ret += (int)st.dwell[i];
+        printf("stats enques:%d deques:%d covers:%d highwater:%d dwell:%d\n",
+                        (int)st.enques, (int)st.deques, (int)st.covers,
+                        (int)st.highwater, ret);
+    }
+#endif
+
     m_cirqueue_free(&que, cbk_free, NULL);
 
     return 0;
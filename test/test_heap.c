@@ -6,6 +6,7 @@
 
 struct element {
     int key;
+    size_t heapidx;
 };
 
 int cbk_compare(void *elem1, void *elem2, void *udt)
@@ -20,6 +21,45 @@ int cbk_compare(void *elem1, void *elem2, void *udt)
         return 0;
 }
 
+#define elem_cmp(a,b) (((a)->key > (b)->key) - ((a)->key < (b)->key))
+M_HEAP_DEFINE(eheap, struct element, elem_cmp, M_HEAP_MIN)
+
+union m_heapkey cbk_getkey(void *elem, void *udt)
+{
+    union m_heapkey key;
+    key.d = ((struct element *)elem)->key / 10.0;
+    return key;
+}
+
+/* counting allocator, ctx is bytes in use */
+void *cnt_alloc(size_t size, void *ctx)
+{
+    size_t *p = (size_t *)malloc(size + sizeof(size_t) * 2);
+    if (!p) return NULL;
+    *p = size;
+    *(size_t *)ctx += size;
+    return p + 2;
+}
+
+void *cnt_realloc(void *ptr, size_t size, void *ctx)
+{
+    size_t *p = ptr ? (size_t *)ptr - 2 : NULL;
+    size_t old = p ? *p : 0;
+    p = (size_t *)realloc(p, size + sizeof(size_t) * 2);
+    if (!p) return NULL;
+    *p = size;
+    *(size_t *)ctx += size - old;
+    return p + 2;
+}
+
+void cnt_free(void *ptr, void *ctx)
+{
+    size_t *p = ptr ? (size_t *)ptr - 2 : NULL;
+    if (!p) return;
+    *(size_t *)ctx -= *p;
+    free(p);
+}
+
 void cbk_free(void *elem, void *udt)
 {
     struct element *em = (struct element *)elem;
@@ -96,5 +136,263 @@ int main()
 
     m_heap_free(&heap, cbk_free, NULL);
 
+    /* type specialized heap test */
+    printf("eheap_init arity4:%d\n",
+                    eheap_init(&heap, M_HEAP_INC | M_HEAP_ARITY4, 4));
+    ret = eheap_init(&heap, M_HEAP_NOINC, 4);
+    if (ret)
+        printf("eheap_init failed:%d\n", ret);
+    srand(9);
+    for (i = 10; i > 0; i--) {
+        struct element *elm = (struct element *)malloc(sizeof(struct element));
+        elm->key = rand() % 100;
+        ret = eheap_insert(&heap, elm);
+        if (ret) {
+            printf("eheap_insert %d failed:%d\n", elm->key, ret);
+            free(elm);
+        }
+    }
+    m_heap_free(&heap, cbk_free, NULL);
+    ret = eheap_init(&heap, M_HEAP_INC, 4);
+    if (ret)
+        printf("eheap_init failed:%d\n", ret);
+    for (i = 10; i > 0; i--) {
+        struct element *elm = (struct element *)malloc(sizeof(struct element));
+        elm->key = rand() % 100;
+        eheap_insert(&heap, elm);
+    }
+    temp = eheap_peek(&heap);
+    ret = eheap_remove(&heap, temp);
+    if (ret)
+        printf("eheap_remove failed:%d\n", ret);
+    else
+        free(temp);
+
+    if (m_heap_judge(&heap))
+        printf("is not a heap\n");
+    else
+        printf("is a heap\n");
+
+    printf("eheap_pop test:\n");
+    while ((temp = eheap_pop(&heap)) != NULL) {
+        printf("%d ", temp->key);
+        free(temp);
+    }
+    printf("\n");
+    m_heap_free(&heap, cbk_free, NULL);
+
+    /* d-ary heap test */
+    {
+        int k = 0;
+        int arity[2] = {M_HEAP_ARITY4, M_HEAP_ARITY8};
+        for (k = 0; k < 2; k++) {
+            m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC | arity[k], 2,
+                            cbk_compare, NULL);
+            srand(9);
+            for (i = 0; i < 30; i++) {
+                struct element *elm = malloc(sizeof(struct element));
+                elm->key = rand() % 100;
+                m_heap_insert(&heap, elm);
+            }
+            if (m_heap_judge(&heap))
+                printf("%d-ary is not a heap\n", heap.arity);
+            else
+                printf("%d-ary is a heap\n", heap.arity);
+            printf("%d-ary pop test:\n", heap.arity);
+            while ((temp = m_heap_pop(&heap)) != NULL) {
+                printf("%d ", temp->key);
+                free(temp);
+            }
+            printf("\n");
+            m_heap_free(&heap, NULL, NULL);
+        }
+    }
+
+    /* build and merge test */
+    {
+        struct m_heap other;
+        struct element *elms[20];
+        m_heap_init(&heap, M_HEAP_MAX, M_HEAP_INC, 4, cbk_compare, NULL);
+        m_heap_init(&other, M_HEAP_MAX, M_HEAP_INC, 4, cbk_compare, NULL);
+        srand(9);
+        for (i = 0; i < 20; i++) {
+            elms[i] = malloc(sizeof(struct element));
+            elms[i]->key = rand() % 100;
+        }
+        ret = m_heap_build(&heap, (void **)elms, 15);
+        if (ret)
+            printf("m_heap_build failed:%d\n", ret);
+        ret = m_heap_build(&other, (void **)&elms[15], 5);
+        if (ret)
+            printf("m_heap_build failed:%d\n", ret);
+        ret = m_heap_merge(&heap, &other);
+        if (ret)
+            printf("m_heap_merge failed:%d\n", ret);
+        if (m_heap_judge(&heap))
+            printf("merged is not a heap\n");
+        else
+            printf("merged is a heap, num:%d other:%d\n",
+                            (int)heap.num, (int)other.num);
+        printf("merged pop test:\n");
+        while ((temp = m_heap_pop(&heap)) != NULL) {
+            printf("%d ", temp->key);
+            free(temp);
+        }
+        printf("\n");
+        m_heap_free(&heap, NULL, NULL);
+        m_heap_free(&other, NULL, NULL);
+    }
+
+    /* index mode test, equal keys removed by identity */
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_INC | M_HEAP_ARITY4, 4,
+                    cbk_compare, NULL);
+    ret = m_heap_set_index(&heap, M_HEAP_OFFSET(struct element, heapidx));
+    if (ret)
+        printf("m_heap_set_index failed:%d\n", ret);
+    {
+        struct element elms[10];
+        for (i = 0; i < 10; i++) {
+            elms[i].key = i % 3;
+            m_heap_insert(&heap, &elms[i]);
+        }
+        ret = m_heap_remove(&heap, &elms[4]);
+        if (ret)
+            printf("m_heap_remove failed:%d\n", ret);
+        ret = m_heap_remove(&heap, &elms[4]);
+        printf("m_heap_remove again:%d\n", ret);
+        elms[8].key = -1;
+        m_heap_update(&heap, &elms[8]);
+        elms[0].key = 5;
+        m_heap_update(&heap, &elms[0]);
+        if (m_heap_judge(&heap))
+            printf("is not a heap\n");
+        else
+            printf("is a heap\n");
+        printf("index pop test:\n");
+        while ((temp = m_heap_pop(&heap)) != NULL)
+            printf("%d:%d ", (int)(temp - elms), temp->key);
+        printf("\n");
+    }
+    m_heap_free(&heap, NULL, NULL);
+
+    /* key mode test, double keys with index mode */
+    m_heap_init(&heap, M_HEAP_MAX, M_HEAP_INC | M_HEAP_ARITY8, 2,
+                    cbk_compare, NULL);
+    m_heap_set_index(&heap, M_HEAP_OFFSET(struct element, heapidx));
+    ret = m_heap_set_key(&heap, M_HEAP_KEY_DOUBLE, cbk_getkey);
+    if (ret)
+        printf("m_heap_set_key failed:%d\n", ret);
+    {
+        struct element elms[20];
+        srand(9);
+        for (i = 0; i < 20; i++) {
+            elms[i].key = rand() % 100 - 50;
+            m_heap_insert(&heap, &elms[i]);
+        }
+        m_heap_remove(&heap, &elms[3]);
+        elms[5].key = 1000;
+        m_heap_update(&heap, &elms[5]);
+        if (m_heap_judge(&heap))
+            printf("is not a heap\n");
+        else
+            printf("is a heap\n");
+        printf("key pop test:\n");
+        while ((temp = m_heap_pop(&heap)) != NULL)
+            printf("%d ", temp->key);
+        printf("\n");
+    }
+    m_heap_free(&heap, NULL, NULL);
+
+    /* top-K test, keep 5 largest of a stream, then drain in batch */
+    m_heap_init(&heap, M_HEAP_MIN, M_HEAP_NOINC | M_HEAP_ARITY4, 5,
+                    cbk_compare, NULL);
+    {
+        int rejected = 0;
+        struct element elms[50];
+        struct element *out[8];
+        srand(9);
+        for (i = 0; i < 50; i++) {
+            elms[i].key = rand() % 1000;
+            temp = m_heap_offer(&heap, &elms[i]);
+            if (temp == &elms[i])
+                rejected++;
+        }
+        printf("m_heap_offer num:%d rejected:%d\n", (int)heap.num, rejected);
+        temp = m_heap_replace(&heap, &elms[0]);
+        printf("m_heap_replace head:%d\n", temp ? temp->key : -1);
+        if (m_heap_judge(&heap))
+            printf("is not a heap\n");
+        else
+            printf("is a heap\n");
+        ret = (int)m_heap_pop_n(&heap, (void **)out, 8);
+        printf("m_heap_pop_n %d:", ret);
+        for (i = 0; i < ret; i++)
+            printf(" %d", out[i]->key);
+        printf("\n");
+    }
+    m_heap_free(&heap, NULL, NULL);
+
+    /* min-max heap test, serve min and evict max */
+    ret = m_heap_init(&heap, M_HEAP_MINMAX, M_HEAP_INC, 4, cbk_compare, NULL);
+    if (ret)
+        printf("m_heap_init minmax failed:%d\n", ret);
+    m_heap_set_index(&heap, M_HEAP_OFFSET(struct element, heapidx));
+    {
+        struct element elms[20];
+        srand(9);
+        for (i = 0; i < 20; i++) {
+            elms[i].key = rand() % 100;
+            m_heap_insert(&heap, &elms[i]);
+        }
+        m_heap_remove(&heap, &elms[7]);
+        elms[2].key = 200;
+        m_heap_update(&heap, &elms[2]);
+        if (m_heap_judge(&heap))
+            printf("is not a minmax heap\n");
+        else
+            printf("is a minmax heap\n");
+        temp = m_heap_peek_min(&heap);
+        printf("peek min:%d", temp->key);
+        temp = m_heap_peek_max(&heap);
+        printf(" max:%d\n", temp->key);
+        printf("minmax pop test:\n");
+        while (heap.num > 0) {
+            temp = m_heap_pop_min(&heap);
+            printf("%d ", temp->key);
+            temp = m_heap_pop_max(&heap);
+            if (temp)
+                printf("%d ", temp->key);
+        }
+        printf("\n");
+    }
+    m_heap_free(&heap, NULL, NULL);
+
+    /* allocator test, memory is returned when shrink heap drained */
+    {
+        size_t inuse = 0;
+        size_t peak = 0;
+        struct element elms[1000];
+        struct m_allocator cnt = {cnt_alloc, cnt_realloc, cnt_free, NULL};
+        cnt.ctx = &inuse;
+        ret = m_heap_init_alloc(&heap, M_HEAP_MIN,
+                        M_HEAP_INC | M_HEAP_SHRINK | M_HEAP_ARITY4, 16,
+                        cbk_compare, NULL, &cnt);
+        if (ret)
+            printf("m_heap_init_alloc failed:%d\n", ret);
+        m_heap_set_key(&heap, M_HEAP_KEY_DOUBLE, cbk_getkey);
+        for (i = 0; i < 1000; i++) {
+            elms[i].key = (i * 7919) % 1000;
+            m_heap_insert(&heap, &elms[i]);
+        }
+        peak = inuse;
+        for (i = 0; i < 990; i++)
+            temp = m_heap_pop(&heap);
+        printf("shrink maxnum:%d judge:%d last pop:%d released:%d\n",
+                        (int)heap.maxnum, m_heap_judge(&heap), temp->key,
+                        inuse < peak / 8);
+        m_heap_free(&heap, NULL, NULL);
+        printf("allocator in use after free:%d\n", (int)inuse);
+    }
+
     return 0;
 }
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "idxlist.h"
+
+#define COUNT   20000
+
+struct element {
+    int key;
+    struct m_idxnode idxnode;
+};
+
+static int freed = 0;
+
+void cbk_free(void *elem, void *udt)
+{
+    freed++;
+}
+
+static struct element elems[COUNT];
+static struct element *model[COUNT];
+
+int main()
+{
+    int i = 0;
+    int j = 0;
+    int n = 0;
+    int pos = 0;
+    int ret = 0;
+    int bad = 0;
+    struct element *temp = NULL;
+    struct m_idxlist idx;
+
+    ret = m_idxlist_init(&idx, M_LIST_OFFSET(struct element, idxnode));
+    if (ret)
+        printf("m_idxlist_init failed:%d\n", ret);
+    else
+        printf("m_idxlist_init success\n");
+
+    printf("m_idxlist_nth empty:%p\n", m_idxlist_nth(&idx, 1));
+
+    /* random inserts, array model holds the expected order */
+    srand(1);
+    for (i = 0; i < COUNT; i++) {
+        elems[i].key = i;
+        pos = rand() % (n + 3);
+        ret = (int)m_idxlist_insert(&idx, &elems[i], pos);
+        if (pos < 1)
+            pos = 1;
+        if (pos > n + 1)
+            pos = n + 1;
+        if (ret != pos)
+            bad++;
+        for (j = n; j >= pos; j--)
+            model[j] = model[j - 1];
+        model[pos - 1] = &elems[i];
+        n++;
+    }
+    printf("m_idxlist_insert %d bad:%d length:%d\n", COUNT, bad,
+                    (int)m_idxlist_length(&idx));
+
+    /* nth, index and the plain list order agree with model */
+    bad = 0;
+    temp = (struct element *)m_list_first(&idx.list);
+    for (i = 0; i < n; i++) {
+        if (m_idxlist_nth(&idx, i + 1) != model[i])
+            bad++;
+        if (m_idxlist_index(&idx, model[i]) != (size_t)i + 1)
+            bad++;
+        if (temp != model[i])
+            bad++;
+        temp = (struct element *)m_list_next(&idx.list, temp);
+    }
+    printf("m_idxlist_nth/index bad:%d\n", bad);
+    printf("m_idxlist_nth out of range:%p %p\n", m_idxlist_nth(&idx, 0),
+                    m_idxlist_nth(&idx, n + 1));
+
+    /* mix removes and pops at random positions */
+    bad = 0;
+    for (i = 0; i < COUNT / 2; i++) {
+        pos = rand() % n + 1;
+        if (i & 1) {
+            ret = m_idxlist_remove(&idx, model[pos - 1]);
+            if (ret)
+                bad++;
+        } else {
+            temp = (struct element *)m_idxlist_pop(&idx, pos);
+            if (temp != model[pos - 1])
+                bad++;
+        }
+        for (j = pos - 1; j < n - 1; j++)
+            model[j] = model[j + 1];
+        n--;
+    }
+    for (i = 0; i < n; i++) {
+        if (m_idxlist_nth(&idx, i + 1) != model[i])
+            bad++;
+        if (m_idxlist_index(&idx, model[i]) != (size_t)i + 1)
+            bad++;
+    }
+    printf("m_idxlist_remove/pop %d bad:%d length:%d\n", COUNT / 2, bad,
+                    (int)m_idxlist_length(&idx));
+
+    /* append goes to the end */
+    bad = 0;
+    for (i = 0; i < 100; i++) {
+        temp = model[i];
+        m_idxlist_remove(&idx, temp);
+        m_idxlist_append(&idx, temp);
+        if (m_idxlist_nth(&idx, n) != temp ||
+            m_idxlist_index(&idx, temp) != (size_t)n)
+            bad++;
+    }
+    printf("m_idxlist_append bad:%d\n", bad);
+
+    ret = m_idxlist_free(&idx, cbk_free, NULL);
+    printf("m_idxlist_free ret:%d freed:%d\n", ret, freed);
+
+    return 0;
+}
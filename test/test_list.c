@@ -41,11 +41,40 @@ static int find_cbk(void *elem, void *key, void *udt)
     else return -1;
 }
 
+/* order by key / 100, so keys of one group show stability */
+static int cmp_cbk(void *a, void *b, void *udt)
+{
+    return ((struct element *)a)->key / 100 - ((struct element *)b)->key / 100;
+}
+
+/* count out of order or unstable neighbours and broken back links */
+static int check_sorted(struct m_list *list)
+{
+    int bad = 0;
+    struct m_listnode *node = NULL;
+    struct element *a = NULL;
+    struct element *b = NULL;
+
+    for (node = list->head; node && node->next; node = node->next) {
+        a = M_LIST_NODE2ELEM(node, list->offset);
+        b = M_LIST_NODE2ELEM(node->next, list->offset);
+        if (a->key > b->key || node->next->prev != node)
+            bad++;
+    }
+    if (node != list->tail || (list->head && list->head->prev))
+        bad++;
+
+    return bad;
+}
+
+static struct element sortelems[10000];
+
 int main()
 {
     int i = 0;
     int ret = 0;
     struct m_list list = {0};
+    struct m_list other;
     struct element *elem = NULL;
 
     /* initialize list */
@@ -165,6 +194,45 @@ int main()
 
     m_list_free(&list, free_cbk, NULL);
 
+    /* sort random groups, equal groups keep insert order */
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+    m_list_init(&other, M_LIST_OFFSET(struct element, listnode));
+    srand(1);
+    for (i = 0; i < 10000; i++) {
+        sortelems[i].key = (rand() % 100) * 100 + i / 100;
+        m_list_append(i < 5000 ? &list : &other, &sortelems[i]);
+    }
+    ret = m_list_sort(&list, cmp_cbk, NULL);
+    printf("m_list_sort ret:%d bad:%d\n", ret, check_sorted(&list));
+    m_list_sort(&other, cmp_cbk, NULL);
+    ret = m_list_merge(&list, &other, cmp_cbk, NULL);
+    printf("m_list_merge ret:%d bad:%d length:%d other:%d\n", ret,
+                    check_sorted(&list),
+                    (int)list.length, (int)other.length);
+    printf("m_list_merge self:%d\n",
+                    m_list_merge(&list, &list, cmp_cbk, NULL));
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+
+    /* sorted, reversed and nearly sorted input */
+    for (i = 0; i < 10000; i++) {
+        sortelems[i].key = i * 100;
+        m_list_prepend(&list, &sortelems[i]);
+    }
+    m_list_sort(&list, cmp_cbk, NULL);
+    printf("m_list_sort reversed bad:%d\n", check_sorted(&list));
+    m_list_sort(&list, cmp_cbk, NULL);
+    printf("m_list_sort sorted bad:%d\n", check_sorted(&list));
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+
+    /* sorted insert */
+    for (i = 0; i < 1000; i++) {
+        sortelems[i].key = (rand() % 10) * 100 + i / 10;
+        m_list_insert_sorted(&list, &sortelems[i], cmp_cbk, NULL);
+    }
+    printf("m_list_insert_sorted bad:%d length:%d\n", check_sorted(&list),
+                    (int)list.length);
+    m_list_init(&list, M_LIST_OFFSET(struct element, listnode));
+
 /*
     int i = 0;
     struct sl_list list;
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "listhash.h"
+
+#define COUNT   10000
+
+struct element {
+    int key;
+    struct m_listnode listnode;
+    struct m_hashnode hashnode;
+};
+
+static int freed = 0;
+
+void cbk_free(void *elem, void *udt)
+{
+    freed++;
+}
+
+size_t cbk_hash(void *key, void *udt)
+{
+    return (size_t)(long)key * 2654435761UL;
+}
+
+int cbk_cmp(void *elem, void *key, void *udt)
+{
+    return ((struct element *)elem)->key == (int)(long)key ? 0 : -1;
+}
+
+static struct element elems[COUNT];
+
+int main()
+{
+    int i = 0;
+    int ret = 0;
+    int bad = 0;
+    struct element dup;
+    struct element *temp = NULL;
+    struct m_listhash lh;
+
+    printf("m_listhash_init too large:%d\n",
+                    m_listhash_init(&lh, M_LIST_OFFSET(struct element, listnode),
+                    M_LIST_OFFSET(struct element, hashnode), (size_t)-1,
+                    cbk_hash, cbk_cmp, NULL));
+    ret = m_listhash_init(&lh, M_LIST_OFFSET(struct element, listnode),
+                    M_LIST_OFFSET(struct element, hashnode), 4,
+                    cbk_hash, cbk_cmp, NULL);
+    if (ret)
+        printf("m_listhash_init failed:%d\n", ret);
+    else
+        printf("m_listhash_init success\n");
+
+    /* keys in shuffled order, list keeps insert order */
+    for (i = 0; i < COUNT; i++) {
+        elems[i].key = (i * 7919) % COUNT;
+        ret = m_listhash_insert(&lh, &elems[i], (void *)(long)elems[i].key);
+        if (ret)
+            bad++;
+    }
+    printf("m_listhash_insert %d bad:%d length:%d buckets:%d\n", COUNT, bad,
+                    (int)m_listhash_length(&lh), (int)lh.mask + 1);
+    dup.key = 5;
+    printf("m_listhash_insert dup:%d\n",
+                    m_listhash_insert(&lh, &dup, (void *)5L));
+
+    bad = 0;
+    for (i = 0; i < COUNT; i++) {
+        temp = (struct element *)m_listhash_find(&lh, (void *)(long)i);
+        if (!temp || temp->key != i)
+            bad++;
+    }
+    printf("m_listhash_find bad:%d missing:%p\n", bad,
+                    m_listhash_find(&lh, (void *)(long)COUNT));
+
+    /* remove even slots by element, odd keys below half by key */
+    bad = 0;
+    for (i = 0; i < COUNT; i += 2)
+        if (m_listhash_remove(&lh, &elems[i]))
+            bad++;
+    for (i = 0; i < COUNT / 2; i++) {
+        temp = (struct element *)m_listhash_find(&lh, (void *)(long)i);
+        if (temp && m_listhash_remove_key(&lh, (void *)(long)i) != temp)
+            bad++;
+    }
+    printf("m_listhash_remove bad:%d again:%d length:%d\n", bad,
+                    m_listhash_remove(&lh, &elems[0]),
+                    (int)m_listhash_length(&lh));
+
+    /* what is left is still in insert order and found by key */
+    bad = 0;
+    i = -1;
+    for (temp = (struct element *)m_list_first(&lh.list); temp;
+         temp = (struct element *)m_list_next(&lh.list, temp)) {
+        if (temp - elems <= i || temp->key < COUNT / 2 ||
+            m_listhash_find(&lh, (void *)(long)temp->key) != temp)
+            bad++;
+        i = (int)(temp - elems);
+    }
+    printf("m_listhash order bad:%d\n", bad);
+
+    ret = m_listhash_free(&lh, cbk_free, NULL);
+    printf("m_listhash_free ret:%d freed:%d\n", ret, freed);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "magicring.h"
+
+#define COUNT   300000
+
+/* variable length record, 'len' bytes of payload follow header */
+struct header {
+    int seq;
+    int len;
+};
+
+static struct m_magicring ring;
+
+static void *producer(void *arg)
+{
+    int seq = 0;
+    size_t len = 0;
+    size_t room = 0;
+    char *p = NULL;
+    struct header hdr;
+
+    for (seq = 0; seq < COUNT; seq++) {
+        len = (size_t)(seq * 7 % 301);
+        while (!(p = (char *)m_magicring_reserve(&ring,
+                        sizeof(hdr) + len, &room)))
+            sched_yield();
+        hdr.seq = seq;
+        hdr.len = (int)len;
+        memcpy(p, &hdr, sizeof(hdr));
+        memset(p + sizeof(hdr), seq & 0xff, len);
+        m_magicring_commit(&ring, sizeof(hdr) + len);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    int i = 0;
+    int seq = 0;
+    int bad = 0;
+    int ret = 0;
+    size_t num = 0;
+    pthread_t tid;
+    char *p = NULL;
+    struct header hdr;
+
+    printf("m_magicring_init too large:%d\n",
+                    m_magicring_init(&ring, (size_t)-1));
+    ret = m_magicring_init(&ring, 1000);
+    if (ret)
+        printf("m_magicring_init failed:%d\n", ret);
+    else
+        printf("m_magicring_init success, capacity:%d\n", (int)ring.cap);
+
+    /* single thread, second mapping alias first, write across the end */
+    ring.base[5] = 'x';
+    printf("alias:%c\n", ring.base[ring.cap + 5]);
+    p = (char *)m_magicring_reserve(&ring, ring.cap - 10, &num);
+    m_magicring_commit(&ring, num - 10);
+    p = (char *)m_magicring_peek(&ring, 1, &num);
+    m_magicring_release(&ring, num);
+    p = (char *)m_magicring_reserve(&ring, 40, &num);
+    printf("m_magicring_reserve after wrap got:%d\n", (int)num);
+    strcpy(p, "span across the end of the ring");
+    m_magicring_commit(&ring, strlen(p) + 1);
+    p = (char *)m_magicring_peek(&ring, 1, &num);
+    printf("m_magicring_peek:%s num:%d\n", p, (int)m_magicring_num(&ring));
+    m_magicring_release(&ring, num);
+    p = (char *)m_magicring_reserve(&ring, ring.cap, &num);
+    m_magicring_commit(&ring, num);
+    printf("m_magicring_reserve full:%d\n",
+                    m_magicring_reserve(&ring, 1, &num) == NULL);
+    p = (char *)m_magicring_peek(&ring, 1, &num);
+    m_magicring_release(&ring, num);
+
+    /* producer thread, consumer parse records in place */
+    pthread_create(&tid, NULL, producer, NULL);
+    while (seq < COUNT) {
+        p = (char *)m_magicring_peek(&ring, sizeof(hdr), &num);
+        if (!p) {
+            sched_yield();
+            continue;
+        }
+        memcpy(&hdr, p, sizeof(hdr));
+        p = (char *)m_magicring_peek(&ring, sizeof(hdr) + hdr.len, &num);
+        if (!p) {
+            sched_yield();
+            continue;
+        }
+        if (hdr.seq != seq)
+            bad++;
+        for (i = 0; i < hdr.len; i++)
+            if (p[sizeof(hdr) + i] != (char)(seq & 0xff))
+                bad++;
+        m_magicring_release(&ring, sizeof(hdr) + hdr.len);
+        seq++;
+    }
+    pthread_join(tid, NULL);
+    printf("transfer %d records, bad:%d\n", COUNT, bad);
+
+    m_magicring_free(&ring);
+    printf("m_magicring_free done\n");
+
+    return 0;
+}
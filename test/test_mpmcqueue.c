@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "mpmcqueue.h"
+
+#define THREADS 4
+#define COUNT   100000
+
+struct element {
+    int key;
+    int producer;
+};
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(em);
+}
+
+static struct m_mpmcqueue que;
+static struct element elems[THREADS][COUNT];
+
+static void *producer(void *arg)
+{
+    int i = 0;
+    struct element *em = (struct element *)arg;
+
+    for (i = 0; i < COUNT; i++)
+        m_mpmcqueue_enque(&que, &em[i]);
+
+    return NULL;
+}
+
+/* count elements, check every producer's elements arrive in order */
+static void *consumer(void *arg)
+{
+    int i = 0;
+    long bad = 0;
+    int last[THREADS];
+    struct element *em = NULL;
+
+    for (i = 0; i < THREADS; i++)
+        last[i] = -1;
+    for (i = 0; i < COUNT; i++) {
+        em = (struct element *)m_mpmcqueue_deque(&que);
+        if (em->key <= last[em->producer])
+            bad++;
+        last[em->producer] = em->key;
+    }
+
+    return (void *)bad;
+}
+
+int main()
+{
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+    long bad = 0;
+    void *res = NULL;
+    struct element *temp = NULL;
+    pthread_t tids[THREADS * 2];
+
+    printf("m_mpmcqueue_init too large:%d\n",
+                    m_mpmcqueue_init(&que, (size_t)-1));
+    ret = m_mpmcqueue_init(&que, 100);
+    if (ret)
+        printf("m_mpmcqueue_init failed:%d\n", ret);
+    else
+        printf("m_mpmcqueue_init success, capacity:%d\n", (int)que.mask + 1);
+
+    /* single thread, full and empty */
+    for (i = 0; i < 129; i++) {
+        ret = m_mpmcqueue_try_enque(&que, &elems[0][i]);
+        if (ret)
+            printf("m_mpmcqueue_try_enque %d failed:%d\n", i, ret);
+    }
+    printf("m_mpmcqueue_num:%d\n", (int)m_mpmcqueue_num(&que));
+    for (i = 0; m_mpmcqueue_try_deque(&que); i++)
+        ;
+    printf("m_mpmcqueue_try_deque %d, empty:%d\n", i,
+                    m_mpmcqueue_try_deque(&que) == NULL);
+
+    for (i = 0; i < THREADS; i++) {
+        for (j = 0; j < COUNT; j++) {
+            elems[i][j].key = j;
+            elems[i][j].producer = i;
+        }
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_create(&tids[i], NULL, producer, elems[i]);
+        pthread_create(&tids[THREADS + i], NULL, consumer, NULL);
+    }
+    for (i = 0; i < THREADS * 2; i++) {
+        pthread_join(tids[i], &res);
+        bad += (long)res;
+    }
+    printf("%d producers %d consumers, out of order:%ld num:%d\n", THREADS,
+                    THREADS, bad, (int)m_mpmcqueue_num(&que));
+
+    for (i = 0; i < 3; i++) {
+        temp = (struct element *)malloc(sizeof(struct element));
+        temp->key = i;
+        m_mpmcqueue_enque(&que, temp);
+    }
+    m_mpmcqueue_free(&que, cbk_free, NULL);
+
+    return 0;
+}
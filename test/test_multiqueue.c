@@ -0,0 +1,111 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "multiqueue.h"
+
+#define THREADS 4
+#define COUNT   10000
+
+struct element {
+    int key;
+};
+
+int cbk_compare(void *elem1, void *elem2, void *udt)
+{
+    struct element *em1 = (struct element *)elem1;
+    struct element *em2 = (struct element *)elem2;
+    if (em1->key > em2->key)
+        return 1;
+    else if (em1->key < em2->key)
+        return -1;
+    else
+        return 0;
+}
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(elem);
+}
+
+static struct m_multiqueue mq;
+static struct element elems[THREADS][COUNT];
+
+static void *worker(void *arg)
+{
+    int i = 0;
+    long popped = 0;
+    struct element *em = (struct element *)arg;
+
+    for (i = 0; i < COUNT; i++) {
+        em[i].key = rand() % 1000;
+        m_multiqueue_insert(&mq, &em[i]);
+        if (i % 2 && m_multiqueue_pop(&mq))
+            popped++;
+    }
+
+    return (void *)popped;
+}
+
+int main()
+{
+    int i = 0;
+    int ret = 0;
+    long popped = 0;
+    void *res = NULL;
+    struct element *temp = NULL;
+    pthread_t tids[THREADS];
+
+    /* strict mode, pop is sorted */
+    ret = m_multiqueue_init(&mq, M_HEAP_MIN, M_MQ_STRICT, 4, cbk_compare, NULL);
+    if (ret)
+        printf("m_multiqueue_init failed:%d\n", ret);
+    else
+        printf("m_multiqueue_init sucess\n");
+
+    srand(9);
+    for (i = 0; i < 10; i++) {
+        struct element *elm = (struct element *)malloc(sizeof(struct element));
+        elm->key = rand() % 100;
+        ret = m_multiqueue_insert(&mq, elm);
+        if (ret)
+            printf("m_multiqueue_insert failed:%d\n", ret);
+        else
+            printf("m_multiqueue_insert %d success\n", elm->key);
+    }
+    temp = m_multiqueue_peek(&mq);
+    printf("m_multiqueue_peek:%d\n", temp ? temp->key : -1);
+
+    printf("m_multiqueue_pop strict test:\n");
+    for (i = 0; i < 5; i++) {
+        temp = m_multiqueue_pop(&mq);
+        printf("%d ", temp->key);
+        free(temp);
+    }
+    printf("\n");
+    m_multiqueue_free(&mq, cbk_free, NULL);
+
+    /* relaxed mode, concurrent insert and pop */
+    m_multiqueue_init(&mq, M_HEAP_MIN, M_MQ_RELAXED, THREADS * 2,
+                    cbk_compare, NULL);
+    for (i = 0; i < THREADS; i++)
+        pthread_create(&tids[i], NULL, worker, elems[i]);
+    for (i = 0; i < THREADS; i++) {
+        pthread_join(tids[i], &res);
+        popped += (long)res;
+    }
+    printf("relaxed inserted:%d popped:%ld left:%d\n", THREADS * COUNT, popped,
+                    (int)m_multiqueue_num(&mq));
+    while (m_multiqueue_pop(&mq))
+        popped++;
+    if (popped == THREADS * COUNT)
+        printf("relaxed pop all success\n");
+    else
+        printf("relaxed pop all failed: %ld\n", popped);
+    m_multiqueue_free(&mq, NULL, NULL);
+
+    return 0;
+}
@@ -89,6 +89,9 @@ int main()
     printf("inorder:");
     m_rbtree_inorder(&tree, cbk_inoder, NULL);
     printf("\n");
+    printf("inorder_prefetch:");
+    m_rbtree_inorder_prefetch(&tree, cbk_inoder, NULL);
+    printf("\n");
     /* test preorder */
     printf("preorder:");
     m_rbtree_preorder(&tree, cbk_inoder, NULL);
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "recqueue.h"
+
+#define COUNT   1000000
+
+struct record {
+    int seq;
+    int check;
+    char payload[24];
+};
+
+void cbk_print(void *rec, void *udt)
+{
+    printf("left:%d\n", ((struct record *)rec)->seq);
+}
+
+static struct m_recqueue que;
+
+/* write records in place, batches of up to 32 */
+static void *producer(void *arg)
+{
+    int seq = 0;
+    size_t i = 0;
+    size_t num = 0;
+    struct record *rec = NULL;
+
+    while (seq < COUNT) {
+        rec = (struct record *)m_recqueue_reserve(&que, 32, &num);
+        if (!rec) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < num && seq < COUNT; i++, seq++) {
+            rec[i].seq = seq;
+            rec[i].check = ~seq;
+        }
+        m_recqueue_commit(&que, i);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    int seq = 0;
+    int bad = 0;
+    int ret = 0;
+    size_t i = 0;
+    size_t num = 0;
+    pthread_t tid;
+    struct record *rec = NULL;
+
+    printf("m_recqueue_init too large:%d overflow:%d\n",
+                    m_recqueue_init(&que, 8, (size_t)-1),
+                    m_recqueue_init(&que, (size_t)1 << 40, (size_t)1 << 30));
+    ret = m_recqueue_init(&que, sizeof(struct record), 100);
+    if (ret)
+        printf("m_recqueue_init failed:%d\n", ret);
+    else
+        printf("m_recqueue_init success, capacity:%d\n", (int)que.mask + 1);
+
+    /* single thread, reserve stop at ring end and when full */
+    rec = (struct record *)m_recqueue_reserve(&que, 100, &num);
+    printf("m_recqueue_reserve 100 got:%d\n", (int)num);
+    m_recqueue_commit(&que, num);
+    rec = (struct record *)m_recqueue_reserve(&que, 100, &num);
+    printf("m_recqueue_reserve 100 got:%d\n", (int)num);
+    m_recqueue_commit(&que, num);
+    rec = (struct record *)m_recqueue_reserve(&que, 1, &num);
+    printf("m_recqueue_reserve full:%d num:%d\n", rec == NULL,
+                    (int)m_recqueue_num(&que));
+    rec = (struct record *)m_recqueue_peek(&que, 90, &num);
+    m_recqueue_release(&que, num);
+    rec = (struct record *)m_recqueue_reserve(&que, 100, &num);
+    printf("m_recqueue_reserve 100 after wrap got:%d\n", (int)num);
+    m_recqueue_commit(&que, 0);
+    rec = (struct record *)m_recqueue_peek(&que, 100, &num);
+    m_recqueue_release(&que, num);
+    printf("m_recqueue_num:%d\n", (int)m_recqueue_num(&que));
+
+    /* producer thread, consumer check order and content in place */
+    pthread_create(&tid, NULL, producer, NULL);
+    while (seq < COUNT) {
+        rec = (struct record *)m_recqueue_peek(&que, 64, &num);
+        if (!rec) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < num; i++, seq++)
+            if (rec[i].seq != seq || rec[i].check != ~seq)
+                bad++;
+        m_recqueue_release(&que, num);
+    }
+    pthread_join(tid, NULL);
+    printf("transfer %d records, bad:%d\n", COUNT, bad);
+
+    rec = (struct record *)m_recqueue_reserve(&que, 2, &num);
+    rec[0].seq = 7;
+    rec[1].seq = 8;
+    m_recqueue_commit(&que, 2);
+    m_recqueue_free(&que, cbk_print, NULL);
+
+    return 0;
+}
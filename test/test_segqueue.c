@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "segqueue.h"
+
+#define COUNT   100000
+
+struct element {
+    int key;
+};
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(em);
+}
+
+static struct element elems[COUNT];
+
+int main()
+{
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+    int bad = 0;
+    int next = 0;
+    int round = 0;
+    struct element *temp = NULL;
+    struct m_segqueue que;
+
+    ret = m_segqueue_init(&que, 16, 4);
+    if (ret)
+        printf("m_segqueue_init failed:%d\n", ret);
+    else
+        printf("m_segqueue_init success\n");
+
+    printf("m_segqueue_deque empty:%p\n", m_segqueue_deque(&que));
+
+    /* grow well past one segment, nothing is covered */
+    for (i = 0; i < 1000; i++) {
+        elems[i].key = i;
+        ret = m_segqueue_enque(&que, &elems[i]);
+        if (ret)
+            printf("m_segqueue_enque %d failed:%d\n", i, ret);
+    }
+    printf("m_segqueue num:%d nseg:%d\n", (int)que.num, (int)que.nseg);
+    temp = (struct element *)m_segqueue_peek(&que);
+    printf("m_segqueue_peek:%d\n", temp->key);
+    for (i = 0; i < 1000; i++) {
+        temp = (struct element *)m_segqueue_deque(&que);
+        if (!temp || temp->key != i)
+            bad++;
+    }
+    printf("m_segqueue_deque 1000 bad:%d num:%d nseg:%d ncache:%d\n", bad,
+                    (int)que.num, (int)que.nseg, (int)que.ncache);
+
+    /* bursts of random depth, order is kept and cache is bounded */
+    srand(1);
+    for (i = 0, round = 0; round < 200; round++) {
+        for (j = rand() % 500; j > 0 && i < COUNT; j--, i++) {
+            elems[i].key = i;
+            m_segqueue_enque(&que, &elems[i]);
+        }
+        for (j = rand() % 500; j > 0; j--) {
+            temp = (struct element *)m_segqueue_deque(&que);
+            if (!temp)
+                break;
+            if (temp->key != next++)
+                bad++;
+        }
+        if (que.ncache > que.maxcache ||
+            que.nseg > que.num / que.segnum + 2)
+            bad++;
+    }
+    while ((temp = (struct element *)m_segqueue_deque(&que)) != NULL)
+        if (temp->key != next++)
+            bad++;
+    printf("m_segqueue bursts %d elements, bad:%d\n", next, bad);
+
+    m_segqueue_trim(&que);
+    printf("m_segqueue_trim ncache:%d\n", (int)que.ncache);
+
+    for (i = 0; i < 3; i++) {
+        temp = (struct element *)malloc(sizeof(struct element));
+        temp->key = i;
+        m_segqueue_enque(&que, temp);
+    }
+    m_segqueue_free(&que, cbk_free, NULL);
+
+    return 0;
+}
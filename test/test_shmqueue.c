@@ -0,0 +1,141 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "shmqueue.h"
+
+#define COUNT   1000000
+
+struct record {
+    int key;
+    int sum;
+    char data[24];
+};
+
+/* consumer process, attach by inherited fds and check order */
+static int consumer(int fd, int efd0, int efd1)
+{
+    int i = 0;
+    int ret = 0;
+    int bad = 0;
+    struct record rec;
+    struct m_shmqueue que;
+
+    ret = m_shmqueue_attach(&que, fd, efd0, efd1);
+    if (ret) {
+        fprintf(stderr, "m_shmqueue_attach failed:%d\n", ret);
+        return 1;
+    }
+    for (i = 0; i < COUNT; i++) {
+        ret = m_shmqueue_deque_wait(&que, &rec, -1);
+        if (ret || rec.key != i || rec.sum != i * 3 + 1)
+            bad++;
+    }
+    m_shmqueue_free(&que);
+
+    return bad ? 1 : 0;
+}
+
+/* attach to a memfd of 'len' bytes holding a forged control block */
+static int attach_forged(struct m_shmqueue *owner, size_t len,
+                    uint64_t size, uint64_t mask, uint64_t dataoff)
+{
+    int ret = 0;
+    int fd = memfd_create("forged", MFD_CLOEXEC);
+    struct m_shmctl ctl;
+    struct m_shmqueue que;
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.magic = M_SHMQ_MAGIC;
+    ctl.size = size;
+    ctl.mask = mask;
+    ctl.dataoff = dataoff;
+    if (fd < 0 || ftruncate(fd, len) < 0 ||
+        pwrite(fd, &ctl, sizeof(ctl), 0) != sizeof(ctl))
+        return M_EUNKNOWN;
+    ret = m_shmqueue_attach(&que, fd, owner->efd[0], owner->efd[1]);
+    if (ret == 0)
+        m_shmqueue_free(&que);
+    close(fd);
+
+    return ret;
+}
+
+int main()
+{
+    int i = 0;
+    int ret = 0;
+    int status = 0;
+    pid_t pid;
+    struct record rec;
+    struct m_shmqueue que;
+
+    printf("m_shmqueue_create too large:%d\n",
+                    m_shmqueue_create(&que, 8, (size_t)-1));
+    ret = m_shmqueue_create(&que, sizeof(struct record), 1000);
+    if (ret)
+        printf("m_shmqueue_create failed:%d\n", ret);
+    else
+        printf("m_shmqueue_create success, capacity:%d\n",
+                    (int)que.mask + 1);
+
+    /* single process, full, empty and timeout */
+    for (i = 0; i < 1025; i++) {
+        rec.key = i;
+        ret = m_shmqueue_enque(&que, &rec);
+        if (ret)
+            printf("m_shmqueue_enque %d failed:%d\n", i, ret);
+    }
+    ret = m_shmqueue_enque_wait(&que, &rec, 10);
+    printf("m_shmqueue_enque_wait on full:%d\n", ret);
+    for (i = 0; m_shmqueue_deque(&que, &rec) == 0; i++)
+        if (rec.key != i)
+            printf("m_shmqueue_deque %d got:%d\n", i, rec.key);
+    printf("m_shmqueue_deque count:%d\n", i);
+    ret = m_shmqueue_deque_wait(&que, &rec, 10);
+    printf("m_shmqueue_deque_wait on empty:%d\n", ret);
+
+    /* two processes */
+    pid = fork();
+    if (pid < 0) {
+        printf("fork failed\n");
+        return 1;
+    }
+    if (pid == 0) {
+        ret = consumer(que.fd, que.efd[0], que.efd[1]);
+        m_shmqueue_free(&que);
+        _exit(ret);
+    }
+    for (i = 0; i < COUNT; i++) {
+        rec.key = i;
+        rec.sum = i * 3 + 1;
+        ret = m_shmqueue_enque_wait(&que, &rec, -1);
+        if (ret)
+            printf("m_shmqueue_enque_wait %d failed:%d\n", i, ret);
+    }
+    waitpid(pid, &status, 0);
+    printf("cross process transfer %d records:%s\n", COUNT,
+                WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "ok" : "bad");
+
+    /* control block of a peer is checked against memfd size */
+    printf("m_shmctl size:%d\n", (int)sizeof(struct m_shmctl));
+    printf("attach forged good:%d\n", attach_forged(&que, 4096, 32, 15, 192));
+    printf("attach forged mask not power of 2:%d\n",
+                    attach_forged(&que, 1 << 20, 32, 1000, 192));
+    printf("attach forged past end of memfd:%d\n",
+                    attach_forged(&que, 4096, 64, 1023, 192));
+    printf("attach forged overflow:%d\n",
+                    attach_forged(&que, 4096, 1UL << 40, (1UL << 40) - 1, 192));
+    printf("attach forged dataoff in ctl:%d\n",
+                    attach_forged(&que, 4096, 32, 15, 8));
+
+    m_shmqueue_free(&que);
+    printf("m_shmqueue_free done\n");
+
+    return 0;
+}
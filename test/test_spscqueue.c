@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "spscqueue.h"
+
+#define COUNT   1000000
+
+struct element {
+    int key;
+};
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(em);
+}
+
+static struct m_spscqueue que;
+static struct element elems[COUNT];
+
+static void *producer(void *arg)
+{
+    int i = 0;
+
+    for (i = 0; i < COUNT; i++) {
+        elems[i].key = i;
+        while (m_spscqueue_enque(&que, &elems[i]))
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    int i = 0;
+    int ret = 0;
+    int bad = 0;
+    pthread_t tid;
+    struct element *temp = NULL;
+
+    printf("m_spscqueue_init too large:%d\n",
+                    m_spscqueue_init(&que, (size_t)-1));
+    ret = m_spscqueue_init(&que, 1000);
+    if (ret)
+        printf("m_spscqueue_init failed:%d\n", ret);
+    else
+        printf("m_spscqueue_init success, capacity:%d\n", (int)que.mask + 1);
+
+    /* single thread, full and empty */
+    for (i = 0; i < 1025; i++) {
+        ret = m_spscqueue_enque(&que, &elems[i]);
+        if (ret)
+            printf("m_spscqueue_enque %d failed:%d\n", i, ret);
+    }
+    printf("m_spscqueue_num:%d\n", (int)m_spscqueue_num(&que));
+    while (m_spscqueue_deque(&que))
+        ;
+    printf("m_spscqueue_num after deque:%d\n", (int)m_spscqueue_num(&que));
+
+    /* producer thread, consumer check order */
+    pthread_create(&tid, NULL, producer, NULL);
+    for (i = 0; i < COUNT; ) {
+        temp = (struct element *)m_spscqueue_deque(&que);
+        if (!temp) {
+            sched_yield();
+            continue;
+        }
+        if (temp->key != i)
+            bad++;
+        i++;
+    }
+    pthread_join(tid, NULL);
+    printf("transfer %d elements, out of order:%d\n", COUNT, bad);
+
+    for (i = 0; i < 3; i++) {
+        temp = (struct element *)malloc(sizeof(struct element));
+        temp->key = i;
+        m_spscqueue_enque(&que, temp);
+    }
+    m_spscqueue_free(&que, cbk_free, NULL);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timerwheel.h"
+
+struct element {
+    int key;
+    unsigned long expire;
+    struct m_timer timer;
+};
+
+static struct m_timerwheel tw;
+static int late = 0;
+
+void cbk_expire(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    if (em->expire != tw.now)
+        late++;
+    free(em);
+}
+
+void cbk_print(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("expire:%d at %lu\n", em->key, tw.now);
+}
+
+void cbk_free(void *elem, void *udt)
+{
+    struct element *em = (struct element *)elem;
+    printf("free:%d\n", em->key);
+    free(em);
+}
+
+int main()
+{
+    int i = 0;
+    int ret = 0;
+    size_t fired = 0;
+    struct element elms[5];
+    unsigned long deltas[5] = {1, 63, 64, 5000, 1UL << 25};
+
+    ret = m_timerwheel_init(&tw, M_TIMER_OFFSET(struct element, timer), 100);
+    if (ret)
+        printf("m_timerwheel_init failed:%d\n", ret);
+    else
+        printf("m_timerwheel_init success\n");
+
+    for (i = 0; i < 5; i++) {
+        elms[i].key = i;
+        elms[i].expire = 100 + deltas[i];
+        m_timerwheel_timer_init(&elms[i].timer);
+        ret = m_timerwheel_add(&tw, &elms[i], elms[i].expire);
+        if (ret)
+            printf("m_timerwheel_add failed:%d\n", ret);
+    }
+    ret = m_timerwheel_add(&tw, &elms[1], 500);
+    printf("m_timerwheel_add pending:%d count:%d\n", ret,
+                    (int)m_timerwheel_count(&tw));
+    ret = m_timerwheel_cancel(&tw, &elms[1]);
+    printf("m_timerwheel_cancel:%d pending:%d\n", ret,
+                    m_timerwheel_pending(&tw, &elms[1]));
+    ret = m_timerwheel_cancel(&tw, &elms[1]);
+    printf("m_timerwheel_cancel again:%d\n", ret);
+    m_timerwheel_mod(&tw, &elms[1], 90);
+
+    fired = m_timerwheel_advance(&tw, 200, cbk_print, NULL);
+    printf("advance to 200 fired:%d count:%d\n", (int)fired,
+                    (int)m_timerwheel_count(&tw));
+    fired = m_timerwheel_advance(&tw, 100 + deltas[4], cbk_print, NULL);
+    printf("advance to %lu fired:%d count:%d\n", tw.now, (int)fired,
+                    (int)m_timerwheel_count(&tw));
+
+    /* random timers, every one must expire at its tick */
+    srand(5);
+    for (i = 0; i < 100000; i++) {
+        struct element *em = (struct element *)malloc(sizeof(struct element));
+        em->key = i;
+        m_timerwheel_timer_init(&em->timer);
+        em->expire = tw.now + 1 + (unsigned long)rand() % 300000;
+        if (i % 1000 == 0)
+            em->expire += 1UL << 24;
+        m_timerwheel_add(&tw, em, em->expire);
+        if (i % 3 == 0) {
+            m_timerwheel_cancel(&tw, em);
+            free(em);
+        }
+    }
+    fired = m_timerwheel_advance(&tw, tw.now + 300001, cbk_expire, NULL);
+    fired += m_timerwheel_advance(&tw, tw.now + (1UL << 24), cbk_expire, NULL);
+    printf("random timers fired:%d late:%d count:%d\n", (int)fired, late,
+                    (int)m_timerwheel_count(&tw));
+
+    for (i = 0; i < 3; i++) {
+        struct element *em = (struct element *)malloc(sizeof(struct element));
+        em->key = i;
+        m_timerwheel_timer_init(&em->timer);
+        m_timerwheel_add(&tw, em, tw.now + 10 + i * 100000000UL);
+    }
+    m_timerwheel_free(&tw, cbk_free, NULL);
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "tracering.h"
+
+#define THREADS 4
+#define COUNT   50000
+
+struct payload {
+    int thread;
+    int seq;
+    char fill[40];
+};
+
+struct checker {
+    unsigned long long lastts;
+    int last[THREADS];
+    long num;
+    long bad;
+};
+
+static struct m_tracering trace;
+
+static void *writer(void *arg)
+{
+    int i = 0;
+    int len = 0;
+    struct payload pl;
+    struct m_tracebuf *buf = m_tracering_attach(&trace);
+
+    pl.thread = (int)(long)arg;
+    for (i = 0; i < COUNT; i++) {
+        pl.seq = i;
+        len = (int)(sizeof(int) * 2) + i % 41;
+        memset(pl.fill, 'a' + i % 26, sizeof(pl.fill));
+        m_tracering_write(buf, 7, &pl, len);
+        if (i % 64 == 0)
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+/* records come in time order, every thread's in sequence and intact */
+static int cbk_check(const struct m_tracerec *rec, size_t idx, void *udt)
+{
+    int i = 0;
+    struct checker *ck = (struct checker *)udt;
+    const struct payload *pl = (const struct payload *)(rec + 1);
+    int fill = (int)rec->len - (int)(sizeof(int) * 2);
+
+    if (rec->ts < ck->lastts || rec->type != 7 ||
+        pl->thread < 0 || pl->thread >= THREADS ||
+        pl->seq <= ck->last[pl->thread] || fill != pl->seq % 41)
+        ck->bad++;
+    for (i = 0; i < fill; i++)
+        if (pl->fill[i] != 'a' + pl->seq % 26)
+            ck->bad++;
+    if (pl->thread >= 0 && pl->thread < THREADS)
+        ck->last[pl->thread] = pl->seq;
+    ck->lastts = rec->ts;
+    ck->num++;
+
+    return 0;
+}
+
+static int cbk_stop(const struct m_tracerec *rec, size_t idx, void *udt)
+{
+    return ++*(int *)udt == 2;
+}
+
+static void run(size_t size, int concurrent)
+{
+    long i = 0;
+    int ret = 0;
+    struct checker ck;
+    pthread_t tids[THREADS];
+
+    memset(&ck, 0, sizeof(ck));
+    for (i = 0; i < THREADS; i++)
+        ck.last[i] = -1;
+    ret = m_tracering_init(&trace, THREADS, size);
+    if (ret)
+        printf("m_tracering_init failed:%d\n", ret);
+
+    for (i = 0; i < THREADS; i++)
+        pthread_create(&tids[i], NULL, writer, (void *)i);
+    if (concurrent) {
+        /* a record committed late may be older than one already read */
+        for (i = 0; i < 200; i++) {
+            ck.lastts = 0;
+            m_tracering_read(&trace, cbk_check, &ck);
+            sched_yield();
+        }
+    }
+    for (i = 0; i < THREADS; i++)
+        pthread_join(tids[i], NULL);
+    ck.lastts = 0;
+    m_tracering_read(&trace, cbk_check, &ck);
+
+    /* a record may be read then covered, so it's counted twice */
+    printf("ring %lu bytes%s: read:%s bad:%ld covered:%s\n",
+                    (unsigned long)size, concurrent ? " concurrent" : "",
+                    ck.num <= THREADS * COUNT &&
+                    ck.num + (long)m_tracering_covers(&trace) >=
+                    THREADS * COUNT ? "ok" : "lost", ck.bad,
+                    m_tracering_covers(&trace) ? "yes" : "no");
+    m_tracering_free(&trace);
+}
+
+int main()
+{
+    int n = 0;
+    int ret = 0;
+    char big[128];
+    struct m_tracebuf *buf = NULL;
+
+    /* single thread basics */
+    printf("m_tracering_init too large:%d\n",
+                    m_tracering_init(&trace, 2, (size_t)-1));
+    ret = m_tracering_init(&trace, 2, 100);
+    printf("m_tracering_init:%d capacity:%d\n", ret,
+                    (int)trace.bufs[0]->mask + 1);
+    buf = m_tracering_attach(&trace);
+    m_tracering_attach(&trace);
+    printf("m_tracering_attach third:%p\n", (void *)m_tracering_attach(&trace));
+    printf("m_tracering_write too large:%d\n",
+                    m_tracering_write(buf, 0, big, sizeof(big)));
+    m_tracering_write(buf, 1, "a", 1);
+    m_tracering_write(buf, 2, "b", 1);
+    m_tracering_write(buf, 3, "c", 1);
+    printf("m_tracering_read stop:%d\n",
+                    m_tracering_read(&trace, cbk_stop, &n));
+    n = 0;
+    printf("m_tracering_read rest:%d\n",
+                    m_tracering_read(&trace, cbk_stop, &n));
+
+    /* detached ring is reused only after its records are read */
+    m_tracering_write(buf, 4, "d", 1);
+    m_tracering_detach(buf);
+    printf("m_tracering_attach before drain:%p\n",
+                    (void *)m_tracering_attach(&trace));
+    n = 0;
+    printf("m_tracering_read detached:%d\n",
+                    m_tracering_read(&trace, cbk_stop, &n));
+    printf("m_tracering_attach after drain:%d\n",
+                    m_tracering_attach(&trace) == buf);
+    m_tracering_free(&trace);
+
+    run(1 << 22, 0);
+    run(4096, 1);
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ulist.h"
+
+#define COUNT   20000
+
+struct element {
+    int key;
+};
+
+static int freed = 0;
+
+void cbk_free(void *elem, void *udt)
+{
+    freed++;
+}
+
+static int find_cbk(void *elem, void *key, void *udt)
+{
+    return ((struct element *)elem)->key == (int)(long)key ? 0 : -1;
+}
+
+static int trav = 0;
+static int travbad = 0;
+static struct element elems[COUNT];
+static struct element *model[COUNT + 1];
+
+static void trav_cbk(void *elem, void *udt)
+{
+    if (elem != model[trav])
+        travbad++;
+    trav += (int)(long)udt;
+}
+
+/* count chunks out of bound and length mismatch */
+static int check_chunks(struct m_ulist *list)
+{
+    int bad = 0;
+    size_t num = 0;
+    size_t nchunk = 0;
+    struct m_ulchunk *chunk = NULL;
+
+    for (chunk = list->head; chunk; chunk = chunk->next) {
+        if (chunk->num == 0 || chunk->num > list->cap)
+            bad++;
+        if (chunk->next && chunk->next->prev != chunk)
+            bad++;
+        num += chunk->num;
+        nchunk++;
+    }
+    if (num != list->length || nchunk != list->nchunk)
+        bad++;
+
+    return bad;
+}
+
+int main()
+{
+    int i = 0;
+    int j = 0;
+    int n = 0;
+    int pos = 0;
+    int ret = 0;
+    int bad = 0;
+    struct element extra;
+    struct element *temp = NULL;
+    struct m_ulist list;
+
+    ret = m_ulist_init(&list, 16);
+    if (ret)
+        printf("m_ulist_init failed:%d\n", ret);
+    else
+        printf("m_ulist_init success\n");
+    printf("m_ulist_init cap 2:%d\n", m_ulist_init(&list, 2));
+    m_ulist_init(&list, 16);
+
+    /* append and prepend leave full chunks */
+    for (i = 0; i < 1000; i++) {
+        elems[i].key = i;
+        ret = i & 1 ? m_ulist_append(&list, &elems[i]) :
+                    m_ulist_prepend(&list, &elems[i]);
+        if (ret)
+            bad++;
+    }
+    printf("m_ulist_append/prepend bad:%d length:%d nchunk:%d chunk bad:%d\n",
+                    bad, (int)m_ulist_length(&list), (int)list.nchunk,
+                    check_chunks(&list));
+    temp = (struct element *)m_ulist_first(&list);
+    printf("m_ulist_first:%d\n", temp->key);
+    temp = (struct element *)m_ulist_last(&list);
+    printf("m_ulist_last:%d\n", temp->key);
+    temp = (struct element *)m_ulist_find(&list, (void *)(long)500, find_cbk,
+                    NULL);
+    printf("m_ulist_find:%d index:%d\n", temp ? temp->key : -1,
+                    (int)m_ulist_index(&list, temp));
+    m_ulist_free(&list, cbk_free, NULL);
+    printf("m_ulist_free freed:%d\n", freed);
+
+    /* random inserts, array model holds the expected order */
+    bad = 0;
+    m_ulist_init(&list, 16);
+    srand(1);
+    for (i = 0; i < COUNT; i++) {
+        elems[i].key = i;
+        pos = rand() % (n + 3);
+        ret = (int)m_ulist_insert(&list, &elems[i], pos);
+        if (pos < 1)
+            pos = 1;
+        if (pos > n + 1)
+            pos = n + 1;
+        if (ret != pos)
+            bad++;
+        for (j = n; j >= pos; j--)
+            model[j] = model[j - 1];
+        model[pos - 1] = &elems[i];
+        n++;
+    }
+    for (i = 0; i < n; i++)
+        if (m_ulist_nth(&list, i + 1) != model[i])
+            bad++;
+    printf("m_ulist_insert %d bad:%d chunk bad:%d\n", COUNT, bad,
+                    check_chunks(&list));
+
+    trav = 0;
+    m_ulist_travarsal(&list, 0, trav_cbk, (void *)1L);
+    trav = n - 1;
+    m_ulist_travarsal(&list, 1, trav_cbk, (void *)-1L);
+    printf("m_ulist_travarsal bad:%d\n", travbad);
+
+    /* shrink by random pops and removes, chunks are merged */
+    bad = 0;
+    for (i = 0; n > 100; i++) {
+        pos = rand() % n + 1;
+        if (i % 3 == 0) {
+            if (m_ulist_remove(&list, model[pos - 1]))
+                bad++;
+        } else if (i % 3 == 1) {
+            if (m_ulist_pop(&list, pos) != model[pos - 1])
+                bad++;
+        } else {
+            pos = (i & 8) ? n : 1;
+            temp = (struct element *)(pos == 1 ? m_ulist_pop_head(&list) :
+                    m_ulist_pop_tail(&list));
+            if (temp != model[pos - 1])
+                bad++;
+        }
+        for (j = pos - 1; j < n - 1; j++)
+            model[j] = model[j + 1];
+        n--;
+    }
+    for (i = 0; i < n; i++)
+        if (m_ulist_nth(&list, i + 1) != model[i] ||
+            m_ulist_index(&list, model[i]) != (size_t)i + 1)
+            bad++;
+    printf("m_ulist_remove/pop bad:%d length:%d nchunk:%d chunk bad:%d\n",
+                    bad, (int)m_ulist_length(&list), (int)list.nchunk,
+                    check_chunks(&list));
+    printf("m_ulist_remove missing:%d index:%d\n",
+                    m_ulist_remove(&list, &extra),
+                    (int)m_ulist_index(&list, &extra));
+
+    freed = 0;
+    m_ulist_free(&list, cbk_free, NULL);
+    printf("m_ulist_free freed:%d\n", freed);
+
+    return 0;
+}